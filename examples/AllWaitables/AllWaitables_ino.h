@@ -37,6 +37,7 @@ namespace crt
 	TestWaitables2 testWaitables2("TestWaitables2", 2 /*priority*/, 4000 /*stackBytes*/, ARDUINO_RUNNING_CORE, testWaitables1);
 	TestWaitables3 testWaitables3("TestWaitables3", 2 /*priority*/, 4000 /*stackBytes*/, ARDUINO_RUNNING_CORE, testWaitables1);
     TestWaitables4 testWaitables4("TestWaitables4", 2 /*priority*/, 4000 /*stackBytes*/, ARDUINO_RUNNING_CORE, testWaitables1);
+    TestWaitables5 testWaitables5("TestWaitables5", 2 /*priority*/, 4000 /*stackBytes*/, ARDUINO_RUNNING_CORE);
 }
 // ********  end of constant part of this .ino file  **************
 
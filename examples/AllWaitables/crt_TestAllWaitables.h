@@ -5,6 +5,7 @@
 
 // This file contains the code of multiple tasks that run concurrently and exchange information.
 // Thus, all types of waitables are tested: flags, queues, timers and periodic timers.
+// TestWaitables5 shows the dispatch order of waitAnyNext, when several waitables fire at once.
 
 // To see the test output in the serial monitor, just press the button that is assigned
 // to the logger.
@@ -241,4 +242,60 @@ namespace crt
             }
         }
     }; // end class TestWaitables4
+
+    // Shows the order in which waitAnyNext hands out waitables that fired at the same time.
+    // The task sets its own flags, so the outcome is always the same:
+    //   do_Priority   : A, B, C    (the order of construction, not the order of setting)
+    //   do_RoundRobin : B, then C, A, B (the search continues after the one handed out previously)
+    class TestWaitables5 : public Task
+    {
+    private:
+        Flag flagA;     // Constructed first, so it has the highest priority for do_Priority.
+        Flag flagB;
+        Flag flagC;
+
+    public:
+        TestWaitables5(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber) :
+            Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), flagA(this), flagB(this), flagC(this)
+        {
+            start();
+        }
+
+    private:
+        const char* nameOf(Waitable* pWaitable)
+        {
+            return (pWaitable == &flagA) ? "flagA" : (pWaitable == &flagB) ? "flagB" : "flagC";
+        }
+
+        void logNext(uint32_t nofWaitables, DispatchOrder dispatchOrder)
+        {
+            for (uint32_t i = 0; i < nofWaitables; i++)
+            {
+                Waitable* pFired = waitAnyNext(flagA + flagB + flagC, dispatchOrder);  // Doesn't wait: the flags were set already.
+                logger.logText(nameOf(pFired));
+            }
+        }
+
+        /*override keyword not supported*/
+        void main()
+        {
+            vTaskDelay(1000); // wait for other threads to have started up as well.
+
+            while (true)
+            {
+                dumpStackHighWaterMarkIfIncreased();
+                vTaskDelay(5000);
+
+                logger.logText("waitAnyNext, do_Priority:");
+                flagC.set(); flagB.set(); flagA.set();
+                logNext(3, DispatchOrder::do_Priority);             // flagA, flagB, flagC
+
+                logger.logText("waitAnyNext, do_RoundRobin:");
+                flagB.set();
+                logNext(1, DispatchOrder::do_RoundRobin);           // flagB
+                flagA.set(); flagB.set(); flagC.set();
+                logNext(3, DispatchOrder::do_RoundRobin);           // flagC, flagA, flagB
+            }
+        }
+    }; // end class TestWaitables5
 };// end namespace crt
@@ -0,0 +1,130 @@
+// by Marius Versteegen, 2023
+
+// This example contains measurements of the performance of CleanRTOS parts.
+// Each benchmark lives in a crt_Bench*.h file of its own.
+// The results are printed to the serial monitor.
+
+// Select the benchmark to run (one at a time, so they don't disturb each other's measurements):
+#define BENCH_QUEUE         // Queue message rate.
+// #define BENCH_POOL       // Aggregate read throughput of a Pool,
+// #define BENCH_RWPOOL     // .. versus that of an RwPool.
+// #define BENCH_LOCKS      // Handoff latency of a SimpleMutex and an AdaptiveMutex between cores.
+// #define BENCH_CRITICALSECTIONS // Enter/exit cost of TaskCriticalSection (global or per resource) and CoreLocalSection.
+// #define BENCH_HANDLER    // Dispatch overhead per period of the Handler (virtual) and the StaticHandler (direct calls).
+// #define BENCH_LOGGER     // Duration of a log via ILogger (virtual) and via DefaultLogger (inlined).
+// #define BENCH_BROADCAST  // Wake-all latency of a BroadcastFlag with 8 waiting tasks.
+// #define BENCH_SEMAPHORE  // Counting resource units with a Semaphore versus a Queue<uint8_t>.
+// #define BENCH_ALLOCATORS // Allocation cost of the heap, a BlockPool and an Arena, and heap fragmentation.
+
+#include <crt_CleanRTOS.h>        // This file includes crt_Config.h  You'll need to change defines there for a release build.
+
+// All Tasks should be created in this main file.
+#include "crt_BenchQueue.h"
+#include "crt_BenchRwPool.h"
+#include "crt_BenchLocks.h"
+#include "crt_BenchCriticalSections.h"
+#include "crt_BenchHandler.h"
+#include "crt_BenchLogger.h"
+#include "crt_BenchBroadcast.h"
+#include "crt_BenchSemaphore.h"
+#include "crt_BenchAllocators.h"
+namespace crt
+{
+	MainInits mainInits;            // Initialize CleanRTOS.
+
+#ifdef BENCH_QUEUE
+	// Consumer and producer on different cores.
+	QueueBenchConsumer queueBenchConsumer("QueueBenchConsumer", 2 /*priority*/, 4000 /*stackBytes*/, 1 /*core*/);
+	QueueBenchProducer queueBenchProducer("QueueBenchProducer", 2 /*priority*/, 4000 /*stackBytes*/, 0 /*core*/, queueBenchConsumer);
+#endif
+
+#if defined(BENCH_POOL) || defined(BENCH_RWPOOL)
+#ifdef BENCH_POOL
+	Pool<CalibrationTable> poolCalibration;
+	const char* poolName = "Pool";
+#else
+	RwPool<CalibrationTable> poolCalibration;
+	const char* poolName = "RwPool";
+#endif
+	typedef decltype(poolCalibration) BenchPool;
+
+	PoolBenchReader<BenchPool> poolBenchReader0("PoolBenchReader0", 1 /*priority*/, 3000 /*stackBytes*/, 0 /*core*/, poolCalibration);
+	PoolBenchReader<BenchPool> poolBenchReader1("PoolBenchReader1", 1 /*priority*/, 3000 /*stackBytes*/, 0 /*core*/, poolCalibration);
+	PoolBenchReader<BenchPool> poolBenchReader2("PoolBenchReader2", 1 /*priority*/, 3000 /*stackBytes*/, 0 /*core*/, poolCalibration);
+	PoolBenchReader<BenchPool> poolBenchReader3("PoolBenchReader3", 1 /*priority*/, 3000 /*stackBytes*/, 0 /*core*/, poolCalibration);
+	PoolBenchReader<BenchPool> poolBenchReader4("PoolBenchReader4", 1 /*priority*/, 3000 /*stackBytes*/, 1 /*core*/, poolCalibration);
+	PoolBenchReader<BenchPool> poolBenchReader5("PoolBenchReader5", 1 /*priority*/, 3000 /*stackBytes*/, 1 /*core*/, poolCalibration);
+	PoolBenchReader<BenchPool> poolBenchReader6("PoolBenchReader6", 1 /*priority*/, 3000 /*stackBytes*/, 1 /*core*/, poolCalibration);
+	PoolBenchReader<BenchPool> poolBenchReader7("PoolBenchReader7", 1 /*priority*/, 3000 /*stackBytes*/, 1 /*core*/, poolCalibration);
+	PoolBenchReader<BenchPool>* arPoolBenchReaders[8] = { &poolBenchReader0, &poolBenchReader1, &poolBenchReader2, &poolBenchReader3,
+	                                                      &poolBenchReader4, &poolBenchReader5, &poolBenchReader6, &poolBenchReader7 };
+	PoolBenchWriterAndReporter<BenchPool> poolBenchWriterAndReporter("PoolBenchWriter", 3 /*priority*/, 4000 /*stackBytes*/, 0 /*core*/,
+	                                                                 poolName, poolCalibration, arPoolBenchReaders);
+#endif
+
+#ifdef BENCH_LOCKS
+	// Short hold time (5 us) and long hold time (500 us), holder on core 0, waiter on core 1.
+	LockBenchShared<SimpleMutex>   lockBenchSharedSimple;
+	LockBenchShared<AdaptiveMutex> lockBenchSharedAdaptive;
+	const uint32_t lockBenchHoldTimeUs = 5;	// Try 500 as well.
+
+	LockBenchHolder<SimpleMutex>   lockBenchHolderSimple  ("LockBenchHolderS", 2 /*priority*/, 3000 /*stackBytes*/, 0 /*core*/, lockBenchSharedSimple, lockBenchHoldTimeUs);
+	LockBenchWaiter<SimpleMutex>   lockBenchWaiterSimple  ("LockBenchWaiterS", 2 /*priority*/, 3000 /*stackBytes*/, 1 /*core*/, "SimpleMutex", lockBenchSharedSimple, lockBenchHoldTimeUs);
+	LockBenchHolder<AdaptiveMutex> lockBenchHolderAdaptive("LockBenchHolderA", 2 /*priority*/, 3000 /*stackBytes*/, 0 /*core*/, lockBenchSharedAdaptive, lockBenchHoldTimeUs);
+	LockBenchWaiter<AdaptiveMutex> lockBenchWaiterAdaptive("LockBenchWaiterA", 2 /*priority*/, 3000 /*stackBytes*/, 1 /*core*/, "AdaptiveMutex", lockBenchSharedAdaptive, lockBenchHoldTimeUs);
+#endif
+
+#ifdef BENCH_CRITICALSECTIONS
+	portMUX_TYPE criticalSectionMutex = portMUX_INITIALIZER_UNLOCKED;	// The global one, used by TaskCriticalSection by default.
+	SpinLock spinLockBenchCounter;
+
+	CriticalSectionBenchHammer   criticalSectionBenchHammer  ("CSBenchHammer",   2 /*priority*/, 3000 /*stackBytes*/, 0 /*core*/);
+	CriticalSectionBenchMeasurer criticalSectionBenchMeasurer("CSBenchMeasurer", 2 /*priority*/, 3000 /*stackBytes*/, 1 /*core*/);
+#endif
+
+#ifdef BENCH_HANDLER
+	HandlerBench handlerBench("HandlerBench", 2 /*priority*/, 3000 /*stackBytes*/, 1 /*core*/);
+#endif
+
+#ifdef BENCH_LOGGER
+	const unsigned int pinButtonDump = 34; // Pressing a button connected to this pin dumps the latest logs to serial monitor.
+	DefaultLogger theLogger("Logger", 2 /*priority*/, ARDUINO_RUNNING_CORE, pinButtonDump);
+	ILogger& logger = theLogger;
+
+	LoggerBench loggerBench("LoggerBench", 2 /*priority*/, 3000 /*stackBytes*/, ARDUINO_RUNNING_CORE, logger);
+#endif
+
+#ifdef BENCH_BROADCAST
+	// Four waiters per core, with a higher priority than the setter.
+	BroadcastBenchShared broadcastBenchShared;
+	BroadcastBenchWaiter broadcastBenchWaiter0("BroadcastWaiter0", 3 /*priority*/, 3000 /*stackBytes*/, 0 /*core*/, broadcastBenchShared, 0);
+	BroadcastBenchWaiter broadcastBenchWaiter1("BroadcastWaiter1", 3 /*priority*/, 3000 /*stackBytes*/, 0 /*core*/, broadcastBenchShared, 1);
+	BroadcastBenchWaiter broadcastBenchWaiter2("BroadcastWaiter2", 3 /*priority*/, 3000 /*stackBytes*/, 0 /*core*/, broadcastBenchShared, 2);
+	BroadcastBenchWaiter broadcastBenchWaiter3("BroadcastWaiter3", 3 /*priority*/, 3000 /*stackBytes*/, 0 /*core*/, broadcastBenchShared, 3);
+	BroadcastBenchWaiter broadcastBenchWaiter4("BroadcastWaiter4", 3 /*priority*/, 3000 /*stackBytes*/, 1 /*core*/, broadcastBenchShared, 4);
+	BroadcastBenchWaiter broadcastBenchWaiter5("BroadcastWaiter5", 3 /*priority*/, 3000 /*stackBytes*/, 1 /*core*/, broadcastBenchShared, 5);
+	BroadcastBenchWaiter broadcastBenchWaiter6("BroadcastWaiter6", 3 /*priority*/, 3000 /*stackBytes*/, 1 /*core*/, broadcastBenchShared, 6);
+	BroadcastBenchWaiter broadcastBenchWaiter7("BroadcastWaiter7", 3 /*priority*/, 3000 /*stackBytes*/, 1 /*core*/, broadcastBenchShared, 7);
+	BroadcastBenchSetter broadcastBenchSetter("BroadcastSetter", 2 /*priority*/, 3000 /*stackBytes*/, 0 /*core*/, broadcastBenchShared);
+#endif
+
+#ifdef BENCH_SEMAPHORE
+	SemaphoreBench semaphoreBench("SemaphoreBench", 2 /*priority*/, 3000 /*stackBytes*/, 1 /*core*/);
+#endif
+
+#ifdef BENCH_ALLOCATORS
+	AllocBenchBlockPool allocBenchBlockPool;
+	AllocBench allocBench0("AllocBench0", 2 /*priority*/, 5000 /*stackBytes*/, 0 /*core*/, allocBenchBlockPool, true /*bShowFragmentation*/);
+	AllocBench allocBench1("AllocBench1", 2 /*priority*/, 5000 /*stackBytes*/, 1 /*core*/, allocBenchBlockPool, false);
+#endif
+}
+
+void setup()
+{
+	ESP_LOGI("checkpoint", "start of main");
+}
+
+void loop()
+{
+	vTaskDelay(1);// Nothing to do in loop - all example code runs in the threads above.
+}
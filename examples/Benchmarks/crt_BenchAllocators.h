@@ -0,0 +1,131 @@
+// by Marius Versteegen, 2023
+
+#pragma once
+#include <crt_CleanRTOS.h>
+
+// This file measures the cost of allocating and freeing a 64 byte block:
+//   * with heap_caps_malloc and heap_caps_free (like new and delete do),
+//   * with a BlockPool, shared by the tasks on both cores,
+//   * with an Arena that belongs to the task itself (freed all at once per batch).
+// A task on each core does the same, at the same time. So the heap and the pool are
+// used concurrently from both cores.
+//
+// After that, one of the tasks shows how the heap fragments: it allocates blocks of
+// random sizes, frees every other one, and logs the total amount of free heap, next to the
+// largest block that can still be allocated from it. The freed holes can only be reused for
+// blocks that fit in them. (A BlockPool or an Arena can't fragment)
+
+namespace crt
+{
+	static const size_t allocBenchBlockSize = 64;
+	static const uint32_t allocBenchBatchSize = 16;
+
+	typedef BlockPool<allocBenchBlockSize, 2 * allocBenchBatchSize + 16> AllocBenchBlockPool;
+
+	class AllocBench : public Task
+	{
+	private:
+		AllocBenchBlockPool& blockPool;
+		Arena<allocBenchBlockSize * allocBenchBatchSize> arena;
+		bool bShowFragmentation;
+		void* arBlocks[allocBenchBatchSize];
+
+	public:
+		AllocBench(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber,
+			AllocBenchBlockPool& blockPool, bool bShowFragmentation) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), blockPool(blockPool), bShowFragmentation(bShowFragmentation)
+		{
+			start();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			vTaskDelay(1000); // wait for other threads to have started up as well.
+			const uint32_t nofBatches = 1000;
+			while (true)
+			{
+				int64_t startUs = esp_timer_get_time();
+				for (uint32_t batch = 0; batch < nofBatches; batch++)
+				{
+					for (uint32_t i = 0; i < allocBenchBatchSize; i++)
+					{
+						arBlocks[i] = heap_caps_malloc(allocBenchBlockSize, MALLOC_CAP_8BIT);
+					}
+					for (uint32_t i = 0; i < allocBenchBatchSize; i++)
+					{
+						heap_caps_free(arBlocks[i]);
+					}
+				}
+				uint32_t heapNs = getNsPerBlock(startUs, nofBatches);
+				vTaskDelay(1);
+
+				startUs = esp_timer_get_time();
+				for (uint32_t batch = 0; batch < nofBatches; batch++)
+				{
+					for (uint32_t i = 0; i < allocBenchBatchSize; i++)
+					{
+						arBlocks[i] = blockPool.allocate();
+					}
+					for (uint32_t i = 0; i < allocBenchBatchSize; i++)
+					{
+						blockPool.deallocate(arBlocks[i]);
+					}
+				}
+				uint32_t blockPoolNs = getNsPerBlock(startUs, nofBatches);
+				vTaskDelay(1);
+
+				startUs = esp_timer_get_time();
+				for (uint32_t batch = 0; batch < nofBatches; batch++)
+				{
+					for (uint32_t i = 0; i < allocBenchBatchSize; i++)
+					{
+						arBlocks[i] = arena.allocate(allocBenchBlockSize);
+					}
+					arena.reset();
+				}
+				uint32_t arenaNs = getNsPerBlock(startUs, nofBatches);
+
+				ESP_LOGI("BenchAllocators", "core %d, allocate + free of %u bytes: heap %u ns, BlockPool %u ns, Arena %u ns (failed BlockPool allocations: %u)",
+					int(xPortGetCoreID()), unsigned(allocBenchBlockSize), unsigned(heapNs), unsigned(blockPoolNs), unsigned(arenaNs),
+					unsigned(blockPool.getNofFailedAllocations()));
+
+				if (bShowFragmentation)
+				{
+					vTaskDelay(100);	// Let the other task finish its measurements first.
+					showHeapFragmentation();
+				}
+				vTaskDelay(1000);
+			}
+		}
+
+		static uint32_t getNsPerBlock(int64_t startUs, uint32_t nofBatches)
+		{
+			return (uint32_t)((esp_timer_get_time() - startUs) * 1000 / (nofBatches * allocBenchBatchSize));
+		}
+
+		void showHeapFragmentation()
+		{
+			static const uint32_t nofBlocks = 200;
+			void* arRandomBlocks[nofBlocks];
+			uint32_t random = 12345;
+
+			for (uint32_t i = 0; i < nofBlocks; i++)
+			{
+				random = random * 1103515245 + 12345;
+				arRandomBlocks[i] = heap_caps_malloc(16 + (random >> 16) % 1024, MALLOC_CAP_8BIT);
+			}
+			for (uint32_t i = 0; i < nofBlocks; i += 2)
+			{
+				heap_caps_free(arRandomBlocks[i]);
+			}
+			ESP_LOGI("BenchAllocators", "heap after random sized allocations: free %u bytes, largest free block %u bytes",
+				unsigned(heap_caps_get_free_size(MALLOC_CAP_8BIT)), unsigned(heap_caps_get_largest_free_block(MALLOC_CAP_8BIT)));
+			for (uint32_t i = 1; i < nofBlocks; i += 2)
+			{
+				heap_caps_free(arRandomBlocks[i]);
+			}
+		}
+	}; // end class AllocBench
+};// end namespace crt
@@ -0,0 +1,108 @@
+// by Marius Versteegen, 2023
+
+#pragma once
+#include <crt_CleanRTOS.h>
+
+// This file measures the wake-all latency of a BroadcastFlag: the time between its set()
+// and the moment that the first and the last of its waiting tasks are running.
+// The waiters report back via a CountdownLatch, which gives the round trip time as well.
+
+namespace crt
+{
+	struct BroadcastBenchShared
+	{
+		static const uint32_t nofWaiters = 8;
+
+		BroadcastBenchShared() : latchDone(nofWaiters), setTimeUs(0), arLatencyUs()
+		{}
+
+		BroadcastFlag<nofWaiters> flagGo;
+		CountdownLatch<1> latchDone;
+		volatile int64_t setTimeUs;
+		volatile uint32_t arLatencyUs[nofWaiters];
+	};
+
+	class BroadcastBenchWaiter : public Task
+	{
+	private:
+		BroadcastBenchShared& shared;
+		uint32_t index;
+		BroadcastFlag<BroadcastBenchShared::nofWaiters>::Subscriber subscriberGo;
+
+	public:
+		BroadcastBenchWaiter(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber,
+			BroadcastBenchShared& shared, uint32_t index) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), shared(shared), index(index), subscriberGo(this, shared.flagGo)
+		{
+			start();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			while (true)
+			{
+				wait(subscriberGo);
+				shared.arLatencyUs[index] = (uint32_t)(esp_timer_get_time() - shared.setTimeUs);
+				shared.latchDone.countDown();
+			}
+		}
+	}; // end class BroadcastBenchWaiter
+
+	class BroadcastBenchSetter : public Task
+	{
+	private:
+		BroadcastBenchShared& shared;
+		CountdownLatch<1>::Subscriber subscriberDone;
+
+	public:
+		BroadcastBenchSetter(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber,
+			BroadcastBenchShared& shared) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), shared(shared), subscriberDone(this, shared.latchDone)
+		{
+			start();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			vTaskDelay(1000); // wait for other threads to have started up as well.
+			const uint32_t nofRounds = 1000;
+			while (true)
+			{
+				uint64_t sumFirstUs = 0;
+				uint64_t sumLastUs = 0;
+				uint64_t sumRoundTripUs = 0;
+				uint32_t maxLastUs = 0;
+
+				for (uint32_t round = 0; round < nofRounds; round++)
+				{
+					shared.latchDone.reset(BroadcastBenchShared::nofWaiters);
+					shared.setTimeUs = esp_timer_get_time();
+					shared.flagGo.set();
+					wait(subscriberDone);
+					sumRoundTripUs += (uint64_t)(esp_timer_get_time() - shared.setTimeUs);
+
+					uint32_t firstUs = 0xFFFFFFFF;
+					uint32_t lastUs = 0;
+					for (uint32_t i = 0; i < BroadcastBenchShared::nofWaiters; i++)
+					{
+						uint32_t latencyUs = shared.arLatencyUs[i];
+						firstUs = (latencyUs < firstUs) ? latencyUs : firstUs;
+						lastUs  = (latencyUs > lastUs)  ? latencyUs : lastUs;
+					}
+					sumFirstUs += firstUs;
+					sumLastUs  += lastUs;
+					maxLastUs = (lastUs > maxLastUs) ? lastUs : maxLastUs;
+				}
+
+				ESP_LOGI("BenchBroadcast", "%u waiters, avg latency first: %u us, last: %u us (max %u us), round trip: %u us",
+					unsigned(BroadcastBenchShared::nofWaiters), unsigned(sumFirstUs / nofRounds), unsigned(sumLastUs / nofRounds),
+					unsigned(maxLastUs), unsigned(sumRoundTripUs / nofRounds));
+				vTaskDelay(1000);
+			}
+		}
+	}; // end class BroadcastBenchSetter
+};// end namespace crt
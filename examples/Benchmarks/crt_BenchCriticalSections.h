@@ -0,0 +1,98 @@
+// by Marius Versteegen, 2023
+
+#pragma once
+#include <crt_CleanRTOS.h>
+#include <internals/crt_TaskCriticalSection.h>
+
+// This file measures the cost of entering and leaving a critical section, for:
+//   * a TaskCriticalSection on the global criticalSectionMutex,
+//   * a TaskCriticalSection on a SpinLock of the resource itself,
+//   * a CoreLocalSection.
+// Meanwhile, a task on the other core keeps entering TaskCriticalSections on the global
+// criticalSectionMutex, for a resource of its own. Only the first variant suffers from that.
+
+namespace crt
+{
+	template <class SECTION> uint32_t measureSectionNs(uint32_t nofCycles, volatile uint32_t& counter)
+	{
+		int64_t startUs = esp_timer_get_time();
+		for (uint32_t i = 0; i < nofCycles; i++)
+		{
+			SECTION section;
+			counter = counter + 1;	// (++ on a volatile is deprecated in C++20)
+		}
+		return (uint32_t)((esp_timer_get_time() - startUs) * 1000 / nofCycles);
+	}
+
+	// The TaskCriticalSection on the spinlock of the resource itself.
+	extern SpinLock spinLockBenchCounter;
+	class ResourceSection
+	{
+	private:
+		TaskCriticalSection taskCriticalSection;
+	public:
+		ResourceSection() : taskCriticalSection(spinLockBenchCounter) {}
+	};
+
+	class CriticalSectionBenchHammer : public Task
+	{
+	private:
+		volatile uint32_t counter;
+
+	public:
+		CriticalSectionBenchHammer(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), counter(0)
+		{
+			start();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			vTaskDelay(1000); // wait for other threads to have started up as well.
+			while (true)
+			{
+				for (uint32_t i = 0; i < 10000; i++)
+				{
+					TaskCriticalSection section;
+					counter = counter + 1;
+				}
+				vTaskDelay(1);	// Keep the watchdog happy.
+			}
+		}
+	}; // end class CriticalSectionBenchHammer
+
+	class CriticalSectionBenchMeasurer : public Task
+	{
+	private:
+		volatile uint32_t counter;
+
+	public:
+		CriticalSectionBenchMeasurer(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), counter(0)
+		{
+			start();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			vTaskDelay(1000); // wait for other threads to have started up as well.
+			const uint32_t nofCycles = 10000;
+			while (true)
+			{
+				uint32_t globalNs = measureSectionNs<TaskCriticalSection>(nofCycles, counter);
+				vTaskDelay(1);
+				uint32_t resourceNs = measureSectionNs<ResourceSection>(nofCycles, counter);
+				vTaskDelay(1);
+				uint32_t coreLocalNs = measureSectionNs<CoreLocalSection>(nofCycles, counter);
+
+				ESP_LOGI("BenchCriticalSections", "enter+exit: global spinlock %u ns, resource spinlock %u ns, core local %u ns",
+					globalNs, resourceNs, coreLocalNs);
+				vTaskDelay(1000);
+			}
+		}
+	}; // end class CriticalSectionBenchMeasurer
+};// end namespace crt
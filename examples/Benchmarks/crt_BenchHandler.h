@@ -0,0 +1,91 @@
+// by Marius Versteegen, 2023
+
+#pragma once
+#include <crt_CleanRTOS.h>
+#include <crt_StaticHandler.h>
+
+// This file measures the dispatch overhead per handler period, for 40 small listeners:
+//   * like the Handler does it: a virtual update() call via an array of IHandlerListener pointers,
+//   * like the StaticHandler does it: direct (inlinable) update() calls.
+
+namespace crt
+{
+	class HandlerBenchListener : public IHandlerListener
+	{
+	public:
+		volatile uint32_t count;	// volatile: keeps the compiler from merging the updates of all periods.
+
+		HandlerBenchListener() : count(0)
+		{}
+
+		/*override keyword not supported in current compiler*/
+		void update()
+		{
+			count = count + 1;	// (++ on a volatile is deprecated in C++20)
+		}
+	};
+
+	// HandlerBenchRepeat<N, T>::type is StaticHandlerListeners<T, T, .. (N times)>
+	template<unsigned int N, typename T, typename... ACC> struct HandlerBenchRepeat
+	{
+		typedef typename HandlerBenchRepeat<N - 1, T, T, ACC...>::type type;
+	};
+
+	template<typename T, typename... ACC> struct HandlerBenchRepeat<0, T, ACC...>
+	{
+		typedef StaticHandlerListeners<ACC...> type;
+	};
+
+	class HandlerBench : public Task
+	{
+	private:
+		static const uint32_t nofListeners = 40;
+
+		HandlerBenchListener arListeners[nofListeners];
+		IHandlerListener* arHandlerListener[nofListeners];
+		HandlerBenchRepeat<nofListeners, HandlerBenchListener>::type staticListeners;
+
+	public:
+		HandlerBench(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber)
+		{
+			for (uint32_t i = 0; i < nofListeners; i++)
+			{
+				arHandlerListener[i] = &arListeners[i];
+			}
+			start();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			vTaskDelay(1000); // wait for other threads to have started up as well.
+			const uint32_t nofFrames = 10000;
+			while (true)
+			{
+				int64_t startUs = esp_timer_get_time();
+				for (uint32_t frame = 0; frame < nofFrames; frame++)
+				{
+					for (uint32_t i = 0; i < nofListeners; i++)
+					{
+						arHandlerListener[i]->update();
+					}
+				}
+				uint32_t virtualNs = (uint32_t)((esp_timer_get_time() - startUs) * 1000 / nofFrames);
+				vTaskDelay(1);
+
+				startUs = esp_timer_get_time();
+				for (uint32_t frame = 0; frame < nofFrames; frame++)
+				{
+					staticListeners.updateAll();
+				}
+				uint32_t staticNs = (uint32_t)((esp_timer_get_time() - startUs) * 1000 / nofFrames);
+
+				ESP_LOGI("BenchHandler", "%u listeners, dispatch time per period: virtual %u ns, static %u ns",
+					unsigned(nofListeners), unsigned(virtualNs), unsigned(staticNs));
+				vTaskDelay(1000);
+			}
+		}
+	}; // end class HandlerBench
+};// end namespace crt
@@ -0,0 +1,116 @@
+// by Marius Versteegen, 2023
+
+#pragma once
+#include <crt_CleanRTOS.h>
+
+// This file measures the handoff latency of a lock between two tasks on different cores:
+// the time between the release of the lock by one task and the moment the other task,
+// which was waiting for it, has it.
+//
+// Both a short hold time (a few us, where an AdaptiveMutex should win by spinning)
+// and a long hold time (where it should fall back to blocking) are measured.
+
+namespace crt
+{
+	template <class LOCK> struct LockBenchShared
+	{
+		LockBenchShared() : releaseTimeUs(0)
+		{}
+
+		LOCK lock;
+		volatile int64_t releaseTimeUs;
+	};
+
+	inline void busyWaitUs(uint32_t durationUs)
+	{
+		int64_t endUs = esp_timer_get_time() + durationUs;
+		while (esp_timer_get_time() < endUs) {}
+	}
+
+	template <class LOCK> class LockBenchHolder : public Task
+	{
+	private:
+		LockBenchShared<LOCK>& shared;
+		uint32_t holdTimeUs;
+
+	public:
+		LockBenchHolder(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber,
+			LockBenchShared<LOCK>& shared, uint32_t holdTimeUs) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), shared(shared), holdTimeUs(holdTimeUs)
+		{
+			start();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			vTaskDelay(1000); // wait for other threads to have started up as well.
+			while (true)
+			{
+				shared.lock.lock();
+				busyWaitUs(holdTimeUs);
+				shared.releaseTimeUs = esp_timer_get_time();
+				shared.lock.unlock();
+				vTaskDelay(1);	// Both tasks wake up at the same tick, after which this one should get the lock first.
+			}
+		}
+	}; // end class LockBenchHolder
+
+	template <class LOCK> class LockBenchWaiter : public Task
+	{
+	private:
+		const char* lockName;
+		LockBenchShared<LOCK>& shared;
+		uint32_t holdTimeUs;
+
+	public:
+		LockBenchWaiter(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber,
+			const char* lockName, LockBenchShared<LOCK>& shared, uint32_t holdTimeUs) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), lockName(lockName), shared(shared), holdTimeUs(holdTimeUs)
+		{
+			start();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			vTaskDelay(1000); // wait for other threads to have started up as well.
+
+			int64_t prevReleaseTimeUs = 0;
+			uint32_t nofHandoffs = 0;
+			uint64_t totalLatencyUs = 0;
+			uint32_t maxLatencyUs = 0;
+
+			while (true)
+			{
+				busyWaitUs(2);	// Make sure the holder locks first.
+				shared.lock.lock();
+				int64_t acquireTimeUs = esp_timer_get_time();
+				int64_t releaseTimeUs = shared.releaseTimeUs;
+				shared.lock.unlock();
+
+				if ((releaseTimeUs != prevReleaseTimeUs) && (acquireTimeUs - releaseTimeUs < 1000))
+				{
+					// It got the lock right after a release by the holder.
+					uint32_t latencyUs = (uint32_t)(acquireTimeUs - releaseTimeUs);
+					totalLatencyUs += latencyUs;
+					if (latencyUs > maxLatencyUs) { maxLatencyUs = latencyUs; }
+					nofHandoffs++;
+				}
+				prevReleaseTimeUs = releaseTimeUs;
+
+				if (nofHandoffs == 1000)
+				{
+					ESP_LOGI("BenchLocks", "%s, hold time %u us: handoff latency avg %u us, max %u us", lockName, holdTimeUs,
+						(uint32_t)(totalLatencyUs / nofHandoffs), maxLatencyUs);
+					nofHandoffs = 0;
+					totalLatencyUs = 0;
+					maxLatencyUs = 0;
+				}
+				vTaskDelay(1);
+			}
+		}
+	}; // end class LockBenchWaiter
+};// end namespace crt
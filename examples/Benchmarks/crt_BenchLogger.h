@@ -0,0 +1,70 @@
+// by Marius Versteegen, 2023
+
+#pragma once
+#include <crt_CleanRTOS.h>
+#include <crt_Logger.h>
+
+// This file measures the time a single log takes:
+//   * via the interface ILogger (a virtual call),
+//   * via the global DefaultLogger object itself (of which the type is known, so it can be inlined).
+//     Note: via a DefaultLogger& it would still be a virtual call, as a reference could refer to
+//     an object of a derived class as well.
+// The buffer of the logger is cleared after every batch of logs, so that every log is stored.
+
+namespace crt
+{
+	extern DefaultLogger theLogger;	// Defined in Benchmarks_ino.h
+
+	class LoggerBench : public Task
+	{
+	private:
+		ILogger& logger;	// Refers to theLogger.
+
+	public:
+		LoggerBench(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber,
+			ILogger& logger) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), logger(logger)
+		{
+			start();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			vTaskDelay(1000); // wait for other threads to have started up as well.
+			const uint32_t nofBatches = 1000;
+			const uint32_t nofLogsPerBatch = DEFAULTLOGGER_LOGSIZE / 2;
+			while (true)
+			{
+				int64_t startUs = esp_timer_get_time();
+				for (uint32_t batch = 0; batch < nofBatches; batch++)
+				{
+					theLogger.clearLogs();
+					for (int32_t i = 0; i < (int32_t)nofLogsPerBatch; i++)
+					{
+						logger.logInt32(i);
+					}
+				}
+				uint32_t virtualNs = (uint32_t)((esp_timer_get_time() - startUs) * 1000 / (nofBatches * nofLogsPerBatch));
+				vTaskDelay(1);
+
+				startUs = esp_timer_get_time();
+				for (uint32_t batch = 0; batch < nofBatches; batch++)
+				{
+					theLogger.clearLogs();
+					for (int32_t i = 0; i < (int32_t)nofLogsPerBatch; i++)
+					{
+						theLogger.logInt32(i);
+					}
+				}
+				uint32_t directNs = (uint32_t)((esp_timer_get_time() - startUs) * 1000 / (nofBatches * nofLogsPerBatch));
+				theLogger.clearLogs();
+
+				// (At 240MHz, a clock cycle takes about 4.2 ns)
+				ESP_LOGI("BenchLogger", "logInt32 via ILogger: %u ns, via DefaultLogger: %u ns", unsigned(virtualNs), unsigned(directNs));
+				vTaskDelay(1000);
+			}
+		}
+	}; // end class LoggerBench
+};// end namespace crt
@@ -0,0 +1,140 @@
+// by Marius Versteegen, 2023
+
+#pragma once
+#include <crt_CleanRTOS.h>
+
+// This file measures the message rate of a Queue:
+// A producer task writes messages as fast as it can (waiting if the queue is full),
+// while the consumer task waits for the queue and reads them.
+//
+// The Queue only touches the event group of its task when it becomes empty or
+// non-empty. When the producer is faster than the consumer, the queue stays non-empty,
+// and no event group operations are needed per message at all.
+//
+// As a baseline, the same messages are passed via a bare FreeRTOS queue with an event group
+// operation per message: the bit is set after each write, and set again after each read
+// if messages are left (the way the Queue used to work).
+
+namespace crt
+{
+	class QueueBenchConsumer : public Task
+	{
+	public:
+		static const int32_t nofMessagesPerRun = 10000;
+
+	private:
+		Queue<int32_t, 10> queueNumbers;
+		QueueHandle_t qhBaseline;
+		Flag flagBaseline;		// Set per message.
+
+	public:
+		QueueBenchConsumer(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), queueNumbers(this, true /*bWriteWaitIfQueueFull*/),
+			qhBaseline(xQueueCreate(10, sizeof(int32_t))), flagBaseline(this)
+		{
+			start();
+		}
+
+		void reportNumber(int32_t number)
+		{
+			queueNumbers.write(number);
+		}
+
+		void reportNumberBaseline(int32_t number)
+		{
+			xQueueSend(qhBaseline, &number, portMAX_DELAY);
+			flagBaseline.set();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			int32_t number = 0;
+			while (true)
+			{
+				dumpStackHighWaterMarkIfIncreased();
+
+				// Wait for the first message of the run, to start timing from there.
+				wait(queueNumbers);
+				uint64_t before = esp_timer_get_time();
+
+				for (int32_t i = 0; i < nofMessagesPerRun; i++)
+				{
+					wait(queueNumbers);
+					queueNumbers.read(number);
+				}
+
+				uint64_t after = esp_timer_get_time();
+				logRate("Queue", (uint32_t)(after - before));
+
+				// The baseline.
+				wait(flagBaseline);
+				readBaseline(number);
+				before = esp_timer_get_time();
+
+				for (int32_t i = 0; i < nofMessagesPerRun; i++)
+				{
+					wait(flagBaseline);
+					readBaseline(number);
+				}
+
+				after = esp_timer_get_time();
+				logRate("baseline", (uint32_t)(after - before));
+			}
+		}
+
+		void readBaseline(int32_t& number)
+		{
+			xQueueReceive(qhBaseline, &number, portMAX_DELAY);
+			if (uxQueueMessagesWaiting(qhBaseline) > 0)
+			{
+				flagBaseline.set();	// The wait cleared the bit.
+			}
+		}
+
+		void logRate(const char* variant, uint32_t durationUs)
+		{
+			ESP_LOGI("BenchQueue", "%s: %d messages in %u us: %u messages/s, %u ns per message",
+				variant, nofMessagesPerRun, durationUs,
+				(uint32_t)((uint64_t)nofMessagesPerRun * 1000000 / durationUs),
+				(uint32_t)((uint64_t)durationUs * 1000 / nofMessagesPerRun));
+		}
+	}; // end class QueueBenchConsumer
+
+	class QueueBenchProducer : public Task
+	{
+	private:
+		QueueBenchConsumer& queueBenchConsumer;
+
+	public:
+		QueueBenchProducer(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber, QueueBenchConsumer& queueBenchConsumer) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), queueBenchConsumer(queueBenchConsumer)
+		{
+			start();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			vTaskDelay(1000); // wait for other threads to have started up as well.
+
+			while (true)
+			{
+				dumpStackHighWaterMarkIfIncreased();
+				for (int32_t i = 0; i <= QueueBenchConsumer::nofMessagesPerRun; i++)
+				{
+					queueBenchConsumer.reportNumber(i);
+				}
+				vTaskDelay(1000);
+
+				for (int32_t i = 0; i <= QueueBenchConsumer::nofMessagesPerRun; i++)
+				{
+					queueBenchConsumer.reportNumberBaseline(i);
+				}
+				vTaskDelay(1000);
+			}
+		}
+	}; // end class QueueBenchProducer
+};// end namespace crt
@@ -0,0 +1,108 @@
+// by Marius Versteegen, 2023
+
+#pragma once
+#include <crt_CleanRTOS.h>
+
+// This file measures the aggregate read throughput of a Pool and an RwPool,
+// when read by 8 tasks (4 on each core) and written once per 100ms.
+// The readers use the in place read(visitor), so no copy of the table is made.
+//
+// With a Pool, all reads are serialised by a single mutex.
+// With an RwPool, the readers on both cores can read at the same time.
+
+namespace crt
+{
+	struct CalibrationTable
+	{
+		CalibrationTable() : version(0)
+		{
+			for (int i = 0; i < 16; i++) { arGain[i] = 1.0f; }
+		}
+
+		uint32_t version;
+		float arGain[16];
+	};
+
+	template <class POOL> class PoolBenchReader : public Task
+	{
+	private:
+		POOL& pool;
+		uint32_t nofReads;	// Only written by this task.
+
+	public:
+		PoolBenchReader(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber, POOL& pool) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), pool(pool), nofReads(0)
+		{
+			start();
+		}
+
+		uint32_t getNofReads()
+		{
+			return nofReads;
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			vTaskDelay(1000); // wait for other threads to have started up as well.
+
+			float sum = 0;
+			while (true)
+			{
+				for (int i = 0; i < 1000; i++)
+				{
+					pool.read([&](const CalibrationTable& table) { sum += table.arGain[i % 16]; });
+					nofReads++;
+				}
+				vTaskDelay(1);	// Give the idle task (and its watchdog) a chance.
+			}
+		}
+	}; // end class PoolBenchReader
+
+	template <class POOL> class PoolBenchWriterAndReporter : public Task
+	{
+	private:
+		const char* poolName;
+		POOL& pool;
+		PoolBenchReader<POOL>* arReaders[8];
+
+	public:
+		PoolBenchWriterAndReporter(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber,
+			const char* poolName, POOL& pool, PoolBenchReader<POOL>* arReaders[8]) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), poolName(poolName), pool(pool)
+		{
+			for (int i = 0; i < 8; i++) { this->arReaders[i] = arReaders[i]; }
+			start();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			vTaskDelay(1000); // wait for other threads to have started up as well.
+
+			CalibrationTable table;
+			uint32_t prevTotal = 0;
+			uint64_t before = esp_timer_get_time();
+			while (true)
+			{
+				for (int i = 0; i < 20; i++)
+				{
+					vTaskDelay(100);
+					table.version++;
+					pool.write(table);	// Written once per 100ms.
+				}
+
+				uint32_t total = 0;
+				for (int i = 0; i < 8; i++) { total += arReaders[i]->getNofReads(); }
+				uint64_t after = esp_timer_get_time();
+
+				ESP_LOGI("BenchPool", "%s: %u reads/s (8 readers on 2 cores)", poolName, 
+					(uint32_t)((uint64_t)(total - prevTotal) * 1000000 / (after - before)));
+				prevTotal = total;
+				before = after;
+			}
+		}
+	}; // end class PoolBenchWriterAndReporter
+};// end namespace crt
@@ -0,0 +1,76 @@
+// by Marius Versteegen, 2023
+
+#pragma once
+#include <crt_CleanRTOS.h>
+
+// This file measures the cost of counting resource units (like free DMA buffers):
+//   * with a Semaphore: an atomic counter,
+//   * with a Queue<uint8_t, N>, as was done before the Semaphore existed: a copy and a
+//     queue critical section per unit.
+// Per batch, all units are given, and then waited for and taken one by one.
+// In both cases, only the first give and the last take of a batch touch the event group.
+
+namespace crt
+{
+	class SemaphoreBench : public Task
+	{
+	private:
+		static const uint32_t nofUnits = 16;
+
+		Semaphore semaphoreUnits;
+		Queue<uint8_t, nofUnits> queueUnits;
+
+	public:
+		SemaphoreBench(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), semaphoreUnits(this, 0, nofUnits), queueUnits(this)
+		{
+			start();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			vTaskDelay(1000); // wait for other threads to have started up as well.
+			const uint32_t nofBatches = 1000;
+			uint8_t unit = 0;
+			while (true)
+			{
+				int64_t startUs = esp_timer_get_time();
+				for (uint32_t batch = 0; batch < nofBatches; batch++)
+				{
+					for (uint32_t i = 0; i < nofUnits; i++)
+					{
+						semaphoreUnits.give();
+					}
+					for (uint32_t i = 0; i < nofUnits; i++)
+					{
+						wait(semaphoreUnits);
+						semaphoreUnits.take();
+					}
+				}
+				uint32_t semaphoreNs = (uint32_t)((esp_timer_get_time() - startUs) * 1000 / (nofBatches * nofUnits));
+				vTaskDelay(1);
+
+				startUs = esp_timer_get_time();
+				for (uint32_t batch = 0; batch < nofBatches; batch++)
+				{
+					for (uint32_t i = 0; i < nofUnits; i++)
+					{
+						queueUnits.write(unit);
+					}
+					for (uint32_t i = 0; i < nofUnits; i++)
+					{
+						wait(queueUnits);
+						queueUnits.read(unit);
+					}
+				}
+				uint32_t queueNs = (uint32_t)((esp_timer_get_time() - startUs) * 1000 / (nofBatches * nofUnits));
+
+				ESP_LOGI("BenchSemaphore", "give + wait + take of a unit: Semaphore %u ns, Queue<uint8_t> %u ns",
+					unsigned(semaphoreNs), unsigned(queueNs));
+				vTaskDelay(1000);
+			}
+		}
+	}; // end class SemaphoreBench
+};// end namespace crt
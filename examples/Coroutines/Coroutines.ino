@@ -0,0 +1,13 @@
+// by Marius Versteegen, 2023
+
+// The ino code has been moved to a header file such that it 
+// can be inspected in non-Arduino IDE environments with 
+// proper code highlighting and intellisense too.
+
+#include "Coroutines_ino.h"
+
+// IMPORTANT: required for this example to work:
+// if you are building from Arduino IDE, make sure to set 
+// the build setting "Core Debug Level" to "info"
+// and select baudrate=115200 in Serial Monitor.
+// Coroutines need C++20: add -std=gnu++20 to the compiler flags.
@@ -0,0 +1,29 @@
+// by Marius Versteegen, 2023
+
+#include <crt_CleanRTOS.h>        // This file includes crt_Config.h  You'll need to change defines there for a release build.
+
+// All Tasks should be created in this main file.
+// A CoScheduler is a task object, so let's include it here.
+#include <crt_CoScheduler.h>
+#include "crt_TestCoroutines.h"
+namespace crt
+{
+	MainInits mainInits;            // Initialize CleanRTOS.
+
+	// A single task (with a single stack) that runs all coroutines below.
+	CoScheduler<50 /*MAXCOROUTINES*/> coScheduler("CoScheduler", 2 /*priority*/, 4000 /*stackBytes*/, ARDUINO_RUNNING_CORE);
+
+	CoCounters coCounters(coScheduler);
+	CoCountersPoker coCountersPoker("CoCountersPoker", 2 /*priority*/, 4000 /*stackBytes*/, ARDUINO_RUNNING_CORE, coCounters);
+}
+
+void setup()
+{
+	crt::coCounters.spawnAll();     // Spawning can be done from any task.
+	ESP_LOGI("checkpoint", "start of main");
+}
+
+void loop()
+{
+	vTaskDelay(1);// Nothing to do in loop - all example code runs in the threads above.
+}
@@ -0,0 +1,107 @@
+// by Marius Versteegen, 2023
+
+#pragma once
+#include <crt_CleanRTOS.h>
+#include <crt_CoScheduler.h>
+
+// This file demonstrates 40 counting coroutines and a coroutine that waits for a Flag,
+// all running within a single task.
+// Compare that with the TenTasks example, which needs 10 tasks (and stacks) for only 10 counters.
+
+namespace crt
+{
+	class CoCounters
+	{
+	private:
+		CoScheduler<50>& coScheduler;
+		Flag flagPoke;				// Owned by the CoScheduler task, because that is where it is waited for.
+		Queue<int32_t, 5> queueNumbers;
+
+	public:
+		CoCounters(CoScheduler<50>& coScheduler) : coScheduler(coScheduler), flagPoke(&coScheduler), queueNumbers(&coScheduler)
+		{
+		}
+
+		void spawnAll()
+		{
+			for (int32_t i = 0; i < 40; i++)
+			{
+				coScheduler.spawn(counter(i));
+			}
+			coScheduler.spawn(pokeListener());
+		}
+
+		// Called by other tasks.
+		void poke()
+		{
+			flagPoke.set();
+		}
+
+		void reportNumber(int32_t number)
+		{
+			queueNumbers.write(number);
+		}
+
+	private:
+		Coroutine counter(int32_t id)
+		{
+			int32_t count = 0;
+			while (true)
+			{
+				co_await coSleep_us(1000000 + id * 10000);	// Sleeps don't block the other coroutines.
+				if ((id % 10) == 0)
+				{
+					ESP_LOGI("counter", "id %d count %d", id, count);
+				}
+				count++;
+			}
+		}
+
+		Coroutine pokeListener()
+		{
+			int32_t number = 0;
+			while (true)
+			{
+				uint32_t firedBits = co_await coWaitAny(flagPoke + queueNumbers);
+				if (firedBits & flagPoke)
+				{
+					ESP_LOGI("pokeListener", "Poked! coroutines alive: %d", coScheduler.getNofCoroutines());
+				}
+				else if (firedBits & queueNumbers)
+				{
+					queueNumbers.read(number);
+					ESP_LOGI("pokeListener", "number: %d", number);
+				}
+			}
+		}
+	}; // end class CoCounters
+
+	class CoCountersPoker : public Task
+	{
+	private:
+		CoCounters& coCounters;
+
+	public:
+		CoCountersPoker(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber, CoCounters& coCounters) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), coCounters(coCounters)
+		{
+			start();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			vTaskDelay(1000); // wait for other threads to have started up as well.
+
+			int32_t i = 0;
+			while (true)
+			{
+				dumpStackHighWaterMarkIfIncreased();
+				vTaskDelay(2000);
+				coCounters.poke();
+				coCounters.reportNumber(i++);
+			}
+		}
+	}; // end class CoCountersPoker
+};// end namespace crt
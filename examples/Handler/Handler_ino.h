@@ -16,8 +16,11 @@ namespace crt
 	ILogger& logger = theLogger;	// This is the global object. It can be accessed without knowledge of the template parameter of theLogger.
 
     MainInits mainInits;            // Initialize CleanRTOS.
-	Handler<10 /*MAXLISTENERCOUNT*/> CounterForTestHandlerHandler("CounterForTestHandlerHandler", 2 /*priority*/, ARDUINO_RUNNING_CORE, 1000 /*periodMs*/, 3000 /*batchTimeUs*/); // Don't forget to call its start() member during setup().
+	// If the periodic updates take more than 500ms, the listeners with priority lower than 1 are skipped for the rest of the period.
+	Handler<11 /*MAXLISTENERCOUNT*/> CounterForTestHandlerHandler("CounterForTestHandlerHandler", 2 /*priority*/, ARDUINO_RUNNING_CORE, 1000 /*periodMs*/, 3000 /*batchTimeUs*/,
+	                                                              500000 /*frameBudgetUs*/, 1 /*minPriorityUnderOverload*/);
 	CounterForTestHandler c0("c0", CounterForTestHandlerHandler);
+	CounterForTestHandler c3("c3", CounterForTestHandlerHandler, 1 /*priority*/, 10000 /*deadlineUs*/);	// Goes first, and is never skipped.
 	CounterForTestHandler c1("c1", CounterForTestHandlerHandler);
 	CounterForTestHandler c2("c2", CounterForTestHandlerHandler);
 	CounterForTestHandler c4("c4", CounterForTestHandlerHandler);
@@ -26,6 +29,7 @@ namespace crt
 	CounterForTestHandler c7("c7", CounterForTestHandlerHandler);
 	CounterForTestHandler c8("c8", CounterForTestHandlerHandler);
 	CounterForTestHandler c9("c9", CounterForTestHandlerHandler);
+	TimerCounterForTestHandler t0("t0", CounterForTestHandlerHandler, 300000 /*period_us*/);	// Called in between the periods of the others.
 }
 
 void setup()
@@ -33,8 +37,6 @@ void setup()
 	// initialize serial communication at 115200 bits per second:
 	// Serial.begin(115200);    // Only needed when using Serial.print();
 
-	crt::CounterForTestHandlerHandler.start();  // IMPORTANT NOTE! a Handler task needs to be started manually,
-								  // AFTER its listeners have been added or have added themselves to the handler.
 	vTaskDelay(10);// allow tasks to initialize.
 	ESP_LOGI("checkpoint", "start of main");vTaskDelay(1);
 }
@@ -17,6 +17,12 @@ namespace crt
 			CounterForTestHandlerHandler.addHandlerListener(this);
 		}
 
+		// With a priority and a deadline (in us, relative to the start of the handler period).
+		CounterForTestHandler(const char *CounterForTestHandlerName, IHandler& CounterForTestHandlerHandler, uint8_t priority, uint32_t deadlineUs) : CounterForTestHandlerName(CounterForTestHandlerName), count(0)
+		{
+			CounterForTestHandlerHandler.addHandlerListener(this, priority, deadlineUs);
+		}
+
 		/*override keyword not supported in current compiler*/
 		void update()
 		{
@@ -24,4 +30,27 @@ namespace crt
 			count++;
 		}
 	}; // end class CounterForTestHandler
+
+	// This listener is event driven: its update() is only called when its timer fires.
+	class TimerCounterForTestHandler : public IHandlerListener
+	{
+	private:
+		const char* timerCounterName;
+		int32_t count;
+		Timer timer;	// Owned by the task of the handler.
+	public:
+		TimerCounterForTestHandler(const char *timerCounterName, IHandler& handler, uint64_t period_us) : 
+			timerCounterName(timerCounterName), count(0), timer(handler.getTask())
+		{
+			handler.addHandlerListener(this, timer);
+			timer.start_periodic(period_us);
+		}
+
+		/*override keyword not supported in current compiler*/
+		void update()
+		{
+			ESP_LOGI(timerCounterName,"%d",count);
+			count++;
+		}
+	}; // end class TimerCounterForTestHandler
 };// end namespace crt
@@ -13,7 +13,7 @@ namespace crt
  	// Create a "global" logger object withing namespace crt.
 	const unsigned int pinButtonDump = 34; // Pressing a button connected to this pin dumps the latest logs to serial monitor.
 	
-	Logger<100> theLogger("Logger", 2 /*priority*/, ARDUINO_RUNNING_CORE, pinButtonDump); // A fast logger for 100 logs.
+	DefaultLogger theLogger("Logger", 2 /*priority*/, ARDUINO_RUNNING_CORE, pinButtonDump); // A fast logger for DEFAULTLOGGER_LOGSIZE (see crt_Config.h) logs.
 	ILogger& logger = theLogger;	// This is the global object. It can be accessed without knowledge of the template parameter of theLogger.
 
     MainInits mainInits;            // Initialize CleanRTOS.
@@ -2,13 +2,15 @@
 
 #pragma once
 #include <crt_CleanRTOS.h>
+#include <crt_Logger.h>
 
 // The code below compares the speed of direct logging with ESP_LOGI to 
-// indirect logging via Logger.
+// indirect logging via Logger, either via its interface ILogger, or via its concrete type.
 
 namespace crt
 {
 	extern ILogger& logger;
+	extern DefaultLogger theLogger;	// The same logger, but without virtual calls.
   
 	class TestLogger : public Task
 	{
@@ -54,10 +56,21 @@ namespace crt
 				logger.logFloat(aFloat);
 				uint64_t afterPostponedLogging = esp_timer_get_time();
 
+				uint64_t beforeDirectLogging = esp_timer_get_time();
+				theLogger.logText("This is some plain text.");
+				theLogger.logText("This is an int32:");
+				theLogger.logInt32(anInt);
+				theLogger.logText("This is a uint32:");
+				theLogger.logUint32(aUint);
+				theLogger.logText("This is a float:");
+				theLogger.logFloat(aFloat);
+				uint64_t afterDirectLogging = esp_timer_get_time();
+
 				logger.dumpNow();
 
 				ESP_LOGI("Immediate logging spent microseconds", "%d", (int32_t)(afterImmediateLogging - beforeImmediateLogging));
 				ESP_LOGI("Postponed logging spent microseconds", "%d", (int32_t)(afterPostponedLogging - beforePostPonedLogging));
+				ESP_LOGI("Postponed logging without virtual calls spent microseconds", "%d", (int32_t)(afterDirectLogging - beforeDirectLogging));
 				ESP_LOGI("", "So for time critical debugging, it's better to use the postponed logger.");
 
 				ESP_LOGI("", "Apart from calling logger.dumpNow(), you can also initiate");
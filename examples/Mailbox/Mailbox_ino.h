@@ -0,0 +1,32 @@
+// by Marius Versteegen, 2023
+
+// This example shows how a Mailbox passes only the latest setpoint to a slow task.
+// The motor controller needs 100ms per setpoint, while a new setpoint arrives every 10ms.
+// The motor controller always continues with the latest setpoint. The ones in between are skipped.
+
+#include <crt_CleanRTOS.h>        // This file includes crt_Config.h  You'll need to change defines there for a release build.
+
+// All Tasks should be created in this main file.
+
+#include "crt_TestMailbox.h"
+namespace crt
+{
+	MainInits mainInits;            // Initialize CleanRTOS.
+
+	MotorController motorController("MotorController", 2 /*priority*/, 4000 /*stackBytes*/, ARDUINO_RUNNING_CORE);
+	SetpointSource  setpointSource ("SetpointSource",  2 /*priority*/, 4000 /*stackBytes*/, ARDUINO_RUNNING_CORE, motorController);
+}
+
+void setup()
+{
+	// initialize serial communication at 115200 bits per second:
+	// Serial.begin(115200); // Only needed when using Serial.print();
+
+	vTaskDelay(10);// allow tasks to initialize.
+	ESP_LOGI("checkpoint", "start of main");vTaskDelay(1);
+}
+
+void loop()
+{
+	vTaskDelay(1);// Nothing to do in loop - all example code runs in the 2 threads above.
+}
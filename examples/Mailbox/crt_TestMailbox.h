@@ -0,0 +1,87 @@
+// by Marius Versteegen, 2023
+
+#pragma once
+#include <crt_CleanRTOS.h>
+
+// This file contains the code of a task that sends setpoints to a (slower) motor controller task.
+// The motor controller is only interested in the latest setpoint, so the setpoints are
+// transferred via a Mailbox: older setpoints that were not read yet simply get overwritten.
+
+namespace crt
+{
+	struct Setpoint
+	{
+		int32_t speed;
+		int32_t direction;
+	};
+
+	class MotorController : public Task
+	{
+	private:
+		Mailbox<Setpoint> mailboxSetpoint;
+
+	public:
+		MotorController(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), mailboxSetpoint(this)
+		{
+			start();
+		}
+
+		// The function below is called by another task.
+		void setSetpoint(const Setpoint& setpoint)
+		{
+			mailboxSetpoint.write(setpoint);
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			Setpoint setpoint = { 0, 0 };
+			while (true)
+			{
+				dumpStackHighWaterMarkIfIncreased(); 		// This function call takes about 0.25ms! It should be called while debugging only.
+
+				wait(mailboxSetpoint);
+				if (!mailboxSetpoint.read(setpoint))
+				{
+					continue;
+				}
+				ESP_LOGI("MotorController", "speed %d, direction %d (setpoints skipped so far: %u)",
+					int(setpoint.speed), int(setpoint.direction), unsigned(mailboxSetpoint.getNofOverwrites()));
+				vTaskDelay(100);							// Simulates the slow adjustment of the motor.
+			}
+		}
+	}; // end class MotorController
+
+	class SetpointSource : public Task
+	{
+	private:
+		MotorController& motorController;
+
+	public:
+		SetpointSource(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber, MotorController& motorController) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), motorController(motorController)
+		{
+			start();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			vTaskDelay(1000); // wait for other threads to have started up as well.
+
+			Setpoint setpoint = { 0, 1 };
+			while (true)
+			{
+				dumpStackHighWaterMarkIfIncreased();
+
+				// Like a knob that is turned: a new setpoint every 10 ms.
+				setpoint.speed = (setpoint.speed + 1) % 100;
+				motorController.setSetpoint(setpoint);
+				vTaskDelay(10);
+			}
+		}
+	}; // end class SetpointSource
+};// end namespace crt
@@ -22,12 +22,13 @@ namespace crt
 	// order of the ids is correct (when multiple mutexes are locked concurrently,
 	// Within each thread (separately), MUTEXES WITH SMALLER ID MUST BE LOCKED BEFORE MUTEXES WITH LARGER ID.
 	
-	Mutex mutexSharedIntA(1);		// Mutex with id 1, which protects sharedIntA
-	Mutex mutexSharedIntB(2);		// Mutex with id 2, which protects sharedIntB
-	Mutex mutexSharedIntC(3);		// Mutex with id 3, ,, . 
+	OrderedMutex<1> mutexSharedIntA;	// Mutex with id 1, which protects sharedIntA
+	OrderedMutex<2> mutexSharedIntB;	// Mutex with id 2, which protects sharedIntB
+	OrderedMutex<3> mutexSharedIntC;	// Mutex with id 3, ,, . 
 	                                // NOTE: it is forbidden to lock a new mutex with an id
 									// that is lower than the highest id of currently locked mutexes.
-									// By using MutexSections, that rule is safeguarded.
+									// By using MutexSections, that rule is safeguarded (at runtime).
+									// By using OrderedMutexSections, it is even checked at compile time.
 
 	SharedNumberIncreaser sharedNumberIncreaserA("SharedNumberIncreaser A", 2 /*priority*/, 4000 /*stackBytes*/, ARDUINO_RUNNING_CORE,
 	                                            sharedIntA, mutexSharedIntA); // Don't forget to call its start() member during setup().
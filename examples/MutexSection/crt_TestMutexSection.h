@@ -12,9 +12,9 @@ namespace crt
 	extern int32_t sharedIntC;
 
 	// The mutexes that guard them.
-	extern Mutex mutexSharedIntA;		// Mutex with id 1, which protects sharedIntA
-	extern Mutex mutexSharedIntB;		// Mutex with id 2, which protects sharedIntB
-	extern Mutex mutexSharedIntC;		// Mutex with id 3, ,, . 
+	extern OrderedMutex<1> mutexSharedIntA;	// Mutex with id 1, which protects sharedIntA
+	extern OrderedMutex<2> mutexSharedIntB;	// Mutex with id 2, which protects sharedIntB
+	extern OrderedMutex<3> mutexSharedIntC;	// Mutex with id 3, ,, . 
 	                                    // NOTE: it is forbidden to lock a new mutex with an id
 				         				// that is lower than the highest id of currently locked mutexes.
 						        		// By using MutexSections, that rule is safeguarded.
@@ -82,9 +82,11 @@ namespace crt
 				vTaskDelay(1000);
 				{
 					ESP_LOGI("SharedNumbersDisplayer", "Waiting to obtain the mutexes");
-				    MutexSection msA(this,mutexSharedIntA);
-					MutexSection msB(this,mutexSharedIntB);
-					MutexSection msC(this,mutexSharedIntC);
+					// The order of the nested mutex sections below is checked at compile time.
+					// (swap msA and msB, and it won't compile)
+				    OrderedMutexSection<1> msA(this,mutexSharedIntA);
+					OrderedMutexSection<2> msB(msA,mutexSharedIntB);
+					OrderedMutexSection<3> msC(msB,mutexSharedIntC);
 					
 					ESP_LOGI("SharedNumbersDisplayer", "Mutexes obtained. no one else can alter the ints now");
 					ESP_LOGI("sharedIntA","%d",sharedIntA);
@@ -99,6 +101,9 @@ namespace crt
 					
 					ESP_LOGI("SharedNumbersDisplayer", "Releasing the mutexes"); // The destructors of MutexSection release the mutexes.
 				}
+#ifdef CRT_MUTEX_PROFILING
+				MutexProfiler::dump();	// Shows how often the increasers had to wait for the mutexes, and for how long.
+#endif
 			}
 		}
 	}; // end class SharedNumbersDisplayer
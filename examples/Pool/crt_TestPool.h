@@ -41,7 +41,7 @@ namespace crt
 			
 			uint64_t count = 0;
 
-			TwoNumbers twoNumbers;							// temp variable to copy to and from the pool.
+			TwoNumbers twoNumbers;							// temp variable to copy from the pool.
 
 			while (true)
 			{
@@ -52,10 +52,13 @@ namespace crt
 				{
 					// increase all numbers by 2.
 					// The numbers in the pool protected TwoNumber object are expected to remain in sync.
-				    poolTwoNumbersA.read(twoNumbers);
-					twoNumbers.number1 += 2;
-					twoNumbers.number2 += 2;
-					poolTwoNumbersA.write(twoNumbers);
+					// Modifying in place takes a single lock, and no increase by another task can get lost
+					// (which could happen with a read, followed by a write).
+					poolTwoNumbersA.modify([](TwoNumbers& pooledNumbers)
+					{
+						pooledNumbers.number1 += 2;
+						pooledNumbers.number2 += 2;
+					});
 					
 					// The numbers in the unprotected TwoNumber object may get out of sync because of 
 					// concurrent access.
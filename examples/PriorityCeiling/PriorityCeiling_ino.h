@@ -0,0 +1,57 @@
+// by Marius Versteegen, 2023
+
+// This example shows how late a high priority task gets hold of a mutex that it shares
+// with a low priority task, while a task with a priority in between keeps the core
+// busy for 20ms at a time. All tasks run on the same core.
+// The lateness is measured from the release time of the high priority task (the moment that
+// its periodic delay ends) till the moment it holds the mutex.
+//
+// Both priority inheritance (the default) and a priority ceiling keep the medium priority task
+// from preempting the low priority task while it holds the mutex. So in both cases, the 
+// lateness stays below the duration of a single critical section (2ms), and the 5ms timeout
+// of the high priority task is not hit.
+// The difference: with inheritance, the high priority task wakes up, blocks on the mutex and
+// then lends its priority. With the ceiling, the low priority task runs at the high priority
+// from the moment it locks the mutex, so the high priority task only gets to run once the mutex
+// is free again (which saves the context switches of blocking).
+// Comment out the define below to compare both.
+
+#define USE_PRIORITY_CEILING
+
+#include <crt_CleanRTOS.h>        // This file includes crt_Config.h  You'll need to change defines there for a release build.
+
+// All Tasks should be created in this main file.
+
+#include "crt_TestPriorityCeiling.h"
+namespace crt
+{
+	MainInits mainInits;            // Initialize CleanRTOS.
+
+	const unsigned int priorityLow    = 1;
+	const unsigned int priorityMedium = 2;
+	const unsigned int priorityHigh   = 3;
+
+#ifdef USE_PRIORITY_CEILING
+	Mutex mutexShared(1, priorityHigh);	// The ceiling is the highest priority of the tasks that use the mutex.
+#else
+	Mutex mutexShared(1);
+#endif
+
+	SharedResourceUser lowPriorityUser ("LowPriorityUser",  priorityLow,  4000 /*stackBytes*/, ARDUINO_RUNNING_CORE, mutexShared, 2000 /*holdUs*/, 3 /*periodMs*/);
+	BusyTask           busyTask        ("BusyTask",         priorityMedium, 4000 /*stackBytes*/, ARDUINO_RUNNING_CORE, 20000 /*busyUs*/, 7 /*periodMs*/);
+	HighPriorityUser   highPriorityUser("HighPriorityUser", priorityHigh, 4000 /*stackBytes*/, ARDUINO_RUNNING_CORE, mutexShared, 10 /*periodMs*/, 5 /*timeoutMs*/);
+}
+
+void setup()
+{
+	// initialize serial communication at 115200 bits per second:
+	// Serial.begin(115200); // Only needed when using Serial.print();
+
+	vTaskDelay(10);// allow tasks to initialize.
+	ESP_LOGI("checkpoint", "start of main");vTaskDelay(1);
+}
+
+void loop()
+{
+	vTaskDelay(1);// Nothing to do in loop - all example code runs in the 3 threads above.
+}
@@ -0,0 +1,137 @@
+// by Marius Versteegen, 2023
+
+#pragma once
+#include <crt_CleanRTOS.h>
+#include <crt_MutexSection.h>
+
+namespace crt
+{
+	inline void busyWaitUs(uint32_t durationUs)
+	{
+		int64_t endUs = esp_timer_get_time() + durationUs;
+		while (esp_timer_get_time() < endUs) {}
+	}
+
+	// Periodically locks the mutex, and holds it for holdUs.
+	class SharedResourceUser : public Task
+	{
+	private:
+		Mutex& mutex;
+		uint32_t holdUs;
+		uint32_t periodMs;
+
+	public:
+		SharedResourceUser(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber,
+		                   Mutex& mutex, uint32_t holdUs, uint32_t periodMs) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), mutex(mutex), holdUs(holdUs), periodMs(periodMs)
+		{
+			start();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			vTaskDelay(1000); // wait for other threads to have started up as well.
+			while (true)
+			{
+				dumpStackHighWaterMarkIfIncreased();
+				{
+					MutexSection ms(this, mutex);
+					busyWaitUs(holdUs);
+				}
+				vTaskDelay(periodMs);
+			}
+		}
+	}; // end class SharedResourceUser
+
+	// Does not use the mutex at all, but keeps the core busy for long stretches.
+	class BusyTask : public Task
+	{
+	private:
+		uint32_t busyUs;
+		uint32_t periodMs;
+
+	public:
+		BusyTask(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber,
+		         uint32_t busyUs, uint32_t periodMs) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), busyUs(busyUs), periodMs(periodMs)
+		{
+			start();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			vTaskDelay(1000); // wait for other threads to have started up as well.
+			while (true)
+			{
+				dumpStackHighWaterMarkIfIncreased();
+				busyWaitUs(busyUs);
+				vTaskDelay(periodMs);
+			}
+		}
+	}; // end class BusyTask
+
+	// Periodically locks the mutex with a timeout, and keeps track of how late it got hold of it
+	// (measured from its release time, so that the time before it got to run counts as well).
+	class HighPriorityUser : public Task
+	{
+	private:
+		Mutex& mutex;
+		uint32_t periodMs;
+		uint32_t timeoutMs;
+
+	public:
+		HighPriorityUser(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber,
+		                 Mutex& mutex, uint32_t periodMs, uint32_t timeoutMs) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), mutex(mutex), periodMs(periodMs), timeoutMs(timeoutMs)
+		{
+			start();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			vTaskDelay(1000); // wait for other threads to have started up as well.
+			uint32_t maxLatenessUs = 0;
+			uint32_t nofTimeouts = 0;
+			uint32_t nofLocks = 0;
+
+			// This task has the highest priority, so right after a delay, it runs at the tick.
+			TickType_t releaseTick = xTaskGetTickCount();
+			int64_t releaseUs = esp_timer_get_time();
+			while (true)
+			{
+				vTaskDelayUntil(&releaseTick, Task::msToTicks(periodMs));
+				releaseUs += (int64_t)periodMs * 1000;	// The moment that the delay above ends.
+
+				dumpStackHighWaterMarkIfIncreased();
+				{
+					MutexSection ms(this, mutex, timeoutMs);
+					int64_t latenessUs = esp_timer_get_time() - releaseUs;
+					if (ms.isLocked())
+					{
+						nofLocks++;
+						if (latenessUs > (int64_t)maxLatenessUs)
+						{
+							maxLatenessUs = (uint32_t)latenessUs;
+						}
+					}
+					else
+					{
+						nofTimeouts++;	// Gave up waiting: a hard-real-time path could fall back on something else here.
+					}
+				}
+
+				if ((nofLocks + nofTimeouts) % 500 == 0)
+				{
+					ESP_LOGI("HighPriorityUser", "locks: %u  timeouts: %u  max lateness: %u us",
+						unsigned(nofLocks), unsigned(nofTimeouts), unsigned(maxLatenessUs));
+				}
+			}
+		}
+	}; // end class HighPriorityUser
+};// end namespace crt
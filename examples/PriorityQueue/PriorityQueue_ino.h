@@ -0,0 +1,35 @@
+// by Marius Versteegen, 2023
+
+// This example shows how a PriorityQueue keeps the latency of commands low, while
+// a slow controller task has a backlog of telemetry messages.
+// The controller needs 10ms per message, while telemetry arrives every 5ms.
+// The latency of a command stays below the handling time of a single message,
+// while a telemetry message waits up to 20 messages (200ms), or gets dropped.
+
+#include <crt_CleanRTOS.h>        // This file includes crt_Config.h  You'll need to change defines there for a release build.
+
+// All Tasks should be created in this main file.
+
+#include "crt_TestPriorityQueue.h"
+namespace crt
+{
+	MainInits mainInits;            // Initialize CleanRTOS.
+
+	Controller    controller     ("Controller",      2 /*priority*/, 4000 /*stackBytes*/, ARDUINO_RUNNING_CORE);
+	MessageSource telemetrySource("TelemetrySource", 2 /*priority*/, 4000 /*stackBytes*/, ARDUINO_RUNNING_CORE, controller, Controller::levelTelemetry, 5 /*periodMs*/);
+	MessageSource commandSource  ("CommandSource",   2 /*priority*/, 4000 /*stackBytes*/, ARDUINO_RUNNING_CORE, controller, Controller::levelCommand, 500 /*periodMs*/);
+}
+
+void setup()
+{
+	// initialize serial communication at 115200 bits per second:
+	// Serial.begin(115200); // Only needed when using Serial.print();
+
+	vTaskDelay(10);// allow tasks to initialize.
+	ESP_LOGI("checkpoint", "start of main");vTaskDelay(1);
+}
+
+void loop()
+{
+	vTaskDelay(1);// Nothing to do in loop - all example code runs in the 3 threads above.
+}
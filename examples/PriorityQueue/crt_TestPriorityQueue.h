@@ -0,0 +1,98 @@
+// by Marius Versteegen, 2023
+
+#pragma once
+#include <crt_CleanRTOS.h>
+
+// This file contains the code of a controller task that receives messages from two other tasks:
+// a lot of telemetry (level 0), and now and then a command (level 1).
+// The controller can't keep up with the telemetry, so a backlog of telemetry builds up.
+// Thanks to the PriorityQueue, the commands don't have to wait behind that backlog.
+
+namespace crt
+{
+	struct ControllerMessage
+	{
+		int32_t value;
+		int64_t writeTimeUs;
+	};
+
+	class Controller : public Task
+	{
+	public:
+		static const uint32_t levelTelemetry = 0;
+		static const uint32_t levelCommand   = 1;
+
+	private:
+		PriorityQueue<ControllerMessage, 20, 2> queueMessages;
+
+	public:
+		Controller(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), queueMessages(this)
+		{
+			start();
+		}
+
+		// Returns false if the level of the message was full.
+		bool sendMessage(int32_t value, uint32_t level)
+		{
+			ControllerMessage message = { value, esp_timer_get_time() };
+			return queueMessages.write(message, level);
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			ControllerMessage message;
+			uint32_t level = 0;
+			while (true)
+			{
+				dumpStackHighWaterMarkIfIncreased(); 		// This function call takes about 0.25ms! It should be called while debugging only.
+
+				wait(queueMessages);
+				if (!queueMessages.read(message, level))
+				{
+					continue;
+				}
+				if (level == levelCommand)
+				{
+					ESP_LOGI("Controller", "command %d, latency %u us, messages waiting: %u, dropped telemetry: %u",
+						int(message.value), unsigned(esp_timer_get_time() - message.writeTimeUs),
+						unsigned(queueMessages.getNofMessagesWaiting()), unsigned(queueMessages.getNofDroppedWrites()));
+				}
+				vTaskDelay(10);								// Simulates the handling of a message.
+			}
+		}
+	}; // end class Controller
+
+	class MessageSource : public Task
+	{
+	private:
+		Controller& controller;
+		uint32_t level;
+		uint32_t periodMs;
+
+	public:
+		MessageSource(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber,
+			Controller& controller, uint32_t level, uint32_t periodMs) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), controller(controller), level(level), periodMs(periodMs)
+		{
+			start();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			vTaskDelay(1000); // wait for other threads to have started up as well.
+
+			int32_t value = 0;
+			while (true)
+			{
+				dumpStackHighWaterMarkIfIncreased();
+				controller.sendMessage(value++, level);
+				vTaskDelay(periodMs);
+			}
+		}
+	}; // end class MessageSource
+};// end namespace crt
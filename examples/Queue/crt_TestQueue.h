@@ -44,7 +44,11 @@ namespace crt
 			{
 				dumpStackHighWaterMarkIfIncreased(); 		// This function call takes about 0.25ms! It should be called while debugging only.
 
-				wait(queueNumbers);
+				if (!wait(queueNumbers, 500 /*timeoutMs*/))	// A timeout does not need a Timer of its own.
+				{
+					ESP_LOGI("NumberDisplayTask", "No new numbers within 500ms");
+					continue;
+				}
                 queueNumbers.read(number);
 				ESP_LOGI("NumberDisplayTask","%d",number);
 			}
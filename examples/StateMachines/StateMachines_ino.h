@@ -0,0 +1,31 @@
+// by Marius Versteegen, 2023
+
+#include <crt_CleanRTOS.h>        // This file includes crt_Config.h  You'll need to change defines there for a release build.
+
+// All Tasks should be created in this main file.
+// A StateMachineTask is a task object, so let's include it here.
+#include <crt_StateMachineTask.h>
+#include "crt_TestStateMachines.h"
+namespace crt
+{
+	MainInits mainInits;            // Initialize CleanRTOS.
+
+	// A single task (with a single stack) that runs all state machines below.
+	StateMachineTask<10 /*MAXSTATEMACHINES*/> stateMachineTask("StateMachineTask", 2 /*priority*/, 4000 /*stackBytes*/, ARDUINO_RUNNING_CORE);
+
+	TrafficLight trafficLightNorth("North", stateMachineTask, 3000000 /*greenTimeUs*/);
+	TrafficLight trafficLightEast ("East",  stateMachineTask, 4000000 /*greenTimeUs*/);
+	TrafficLight trafficLightSouth("South", stateMachineTask, 3000000 /*greenTimeUs*/);
+
+	Mechanic mechanic("Mechanic", 2 /*priority*/, 4000 /*stackBytes*/, ARDUINO_RUNNING_CORE, trafficLightEast);
+}
+
+void setup()
+{
+	ESP_LOGI("checkpoint", "start of main");
+}
+
+void loop()
+{
+	vTaskDelay(1);// Nothing to do in loop - all example code runs in the threads above.
+}
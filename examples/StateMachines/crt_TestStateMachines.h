@@ -0,0 +1,121 @@
+// by Marius Versteegen, 2023
+
+#pragma once
+#include <crt_CleanRTOS.h>
+#include <crt_StateMachineTask.h>
+
+// This file demonstrates traffic lights, implemented as state machines.
+// All of them run within a single StateMachineTask (and thus share a single stack).
+// Compare that with the TenTasks example, where every counter has a task of its own.
+
+namespace crt
+{
+	class TrafficLight : public StateMachine<TrafficLight>
+	{
+	private:
+		enum State { stRed, stGreen, stYellow, stBlinking };
+
+		const char* name;
+		uint64_t greenTimeUs;
+		Timer timer;				// Owned by the StateMachineTask, because that is where it is waited for.
+		Flag flagMalfunction;
+		Flag flagRepaired;
+
+	public:
+		TrafficLight(const char* name, IStateMachineTask& stateMachineTask, uint64_t greenTimeUs) :
+			StateMachine(stateMachineTask, stRed), name(name), greenTimeUs(greenTimeUs),
+			timer(stateMachineTask.getTask()), flagMalfunction(stateMachineTask.getTask()), flagRepaired(stateMachineTask.getTask())
+		{
+			on(stRed,      timer,           &TrafficLight::onRedTimeout);
+			on(stGreen,    timer,           &TrafficLight::onGreenTimeout);
+			on(stYellow,   timer,           &TrafficLight::onYellowTimeout);
+			on(stBlinking, timer,           &TrafficLight::onBlinkTimeout);
+			on(stBlinking, flagRepaired,    &TrafficLight::onRepaired);
+			on(anyState,   flagMalfunction, &TrafficLight::onMalfunction);
+			timer.start(2000000);
+		}
+
+		// Called by other tasks.
+		void reportMalfunction()
+		{
+			flagMalfunction.set();
+		}
+
+		void reportRepaired()
+		{
+			flagRepaired.set();		// Only handled while blinking.
+		}
+
+	private:
+		void onRedTimeout()
+		{
+			ESP_LOGI(name, "green");
+			setState(stGreen);
+			timer.start(greenTimeUs);
+		}
+
+		void onGreenTimeout()
+		{
+			ESP_LOGI(name, "yellow");
+			setState(stYellow);
+			timer.start(1000000);
+		}
+
+		void onYellowTimeout()
+		{
+			ESP_LOGI(name, "red");
+			setState(stRed);
+			timer.start(2000000);
+		}
+
+		void onMalfunction()
+		{
+			ESP_LOGI(name, "malfunction: blinking yellow");
+			setState(stBlinking);
+			timer.start(500000);
+		}
+
+		void onBlinkTimeout()
+		{
+			ESP_LOGI(name, "blink");
+			timer.start(500000);
+		}
+
+		void onRepaired()
+		{
+			ESP_LOGI(name, "repaired: red");
+			timer.stop();
+			setState(stRed);
+			timer.start(2000000);
+		}
+	}; // end class TrafficLight
+
+	// A normal task, that breaks and repairs a traffic light once in a while.
+	class Mechanic : public Task
+	{
+	private:
+		TrafficLight& trafficLight;
+
+	public:
+		Mechanic(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber, TrafficLight& trafficLight) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), trafficLight(trafficLight)
+		{
+			start();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			vTaskDelay(1000); // wait for other threads to have started up as well.
+			while (true)
+			{
+				dumpStackHighWaterMarkIfIncreased();
+				vTaskDelay(15000);
+				trafficLight.reportMalfunction();
+				vTaskDelay(5000);
+				trafficLight.reportRepaired();
+			}
+		}
+	}; // end class Mechanic
+};// end namespace crt
@@ -0,0 +1,40 @@
+// by Marius Versteegen, 2023
+
+// This example shows how a TokenBucket paces a producer task, such that it doesn't
+// flood a slower consumer task. The consumer handles about 50 numbers per second.
+// The producer would like to send 200 numbers per second, in bursts.
+//
+// Comment out the define below to see what happens without the TokenBucket:
+// the queue of the consumer reaches its high-water mark, and writes get dropped.
+// With the TokenBucket, the producer is limited to 40 numbers per second (with bursts
+// of at most 5 numbers), and nothing gets dropped.
+
+#define USE_TOKEN_BUCKET
+
+#include <crt_CleanRTOS.h>        // This file includes crt_Config.h  You'll need to change defines there for a release build.
+
+// All Tasks should be created in this main file.
+
+#include "crt_TestTokenBucket.h"
+namespace crt
+{
+	MainInits mainInits;            // Initialize CleanRTOS.
+
+	NumberConsumer numberConsumer("NumberConsumer", 2 /*priority*/, 4000 /*stackBytes*/, ARDUINO_RUNNING_CORE, 20 /*msPerNumber*/);
+	NumberProducer numberProducer("NumberProducer", 2 /*priority*/, 4000 /*stackBytes*/, ARDUINO_RUNNING_CORE, numberConsumer,
+	                              40 /*numbersPerSecond*/, 5 /*burstSize*/);
+}
+
+void setup()
+{
+	// initialize serial communication at 115200 bits per second:
+	// Serial.begin(115200); // Only needed when using Serial.print();
+
+	vTaskDelay(10);// allow tasks to initialize.
+	ESP_LOGI("checkpoint", "start of main");vTaskDelay(1);
+}
+
+void loop()
+{
+	vTaskDelay(1);// Nothing to do in loop - all example code runs in the 2 threads above.
+}
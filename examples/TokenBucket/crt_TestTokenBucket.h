@@ -0,0 +1,102 @@
+// by Marius Versteegen, 2023
+
+#pragma once
+#include <crt_CleanRTOS.h>
+
+// This file contains the code of a producer task that sends numbers to a slower consumer task.
+// The producer paces itself with a TokenBucket (if USE_TOKEN_BUCKET is defined).
+// Once per second, the producer reports the statistics of the queue of the consumer.
+// (kept by the QueueStatsRecorder: the high-water mark, the dropped writes, the latency, etc.)
+
+namespace crt
+{
+	class NumberConsumer : public Task
+	{
+	private:
+		Queue<int32_t, 10, QueueStatsRecorder> queueNumbers;
+		uint32_t msPerNumber;
+
+	public:
+		NumberConsumer(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber, uint32_t msPerNumber) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), queueNumbers(this), msPerNumber(msPerNumber)
+		{
+			start();
+		}
+
+		// Returns false if the queue was full.
+		bool consumeNumber(int32_t number)
+		{
+			return queueNumbers.write(number);
+		}
+
+		void reportStats()
+		{
+			queueNumbers.logStats("queueNumbers");
+			queueNumbers.resetStats();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			int32_t number = 0;
+			while (true)
+			{
+				dumpStackHighWaterMarkIfIncreased(); 		// This function call takes about 0.25ms! It should be called while debugging only.
+
+				wait(queueNumbers);
+				queueNumbers.read(number);
+				vTaskDelay(msPerNumber);					// Simulates the processing of the number.
+			}
+		}
+	}; // end class NumberConsumer
+
+	class NumberProducer : public Task
+	{
+	private:
+		NumberConsumer& numberConsumer;
+		TokenBucket tokenBucket;
+
+	public:
+		NumberProducer(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber,
+			NumberConsumer& numberConsumer, uint32_t numbersPerSecond, uint32_t burstSize) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), numberConsumer(numberConsumer),
+			tokenBucket(this, numbersPerSecond, burstSize)
+		{
+			start();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			vTaskDelay(1000); // wait for other threads to have started up as well.
+
+			int32_t number = 0;
+			int64_t lastReportUs = esp_timer_get_time();
+			while (true)
+			{
+				dumpStackHighWaterMarkIfIncreased();
+
+				// Try to produce a burst of 10 numbers every 50 ms.
+				for (int n = 0; n < 10; n++)
+				{
+#ifdef USE_TOKEN_BUCKET
+					while (!tokenBucket.take())
+					{
+						wait(tokenBucket);
+					}
+#endif
+					numberConsumer.consumeNumber(number++);
+				}
+				vTaskDelay(50);
+
+				if (esp_timer_get_time() - lastReportUs >= 1000000)
+				{
+					numberConsumer.reportStats();
+					lastReportUs = esp_timer_get_time();
+				}
+			}
+		}
+	}; // end class NumberProducer
+};// end namespace crt
@@ -0,0 +1,28 @@
+// by Marius Versteegen, 2023
+
+#include <crt_CleanRTOS.h>        // This file includes crt_Config.h  You'll need to change defines there for a release build.
+
+// All Tasks should be created in this main file.
+#include "crt_TestTopic.h"
+namespace crt
+{
+	MainInits mainInits;            // Initialize CleanRTOS.
+
+	// Shared resources
+	Topic<int32_t, 8 /*DEPTH*/> topicNumbers;
+
+	NumberSubscriber numberSubscriberA("NumberSubscriber A", 2 /*priority*/, 4000 /*stackBytes*/, ARDUINO_RUNNING_CORE, 0    /*processingTimeMs*/);
+	NumberSubscriber numberSubscriberB("NumberSubscriber B", 2 /*priority*/, 4000 /*stackBytes*/, ARDUINO_RUNNING_CORE, 0    /*processingTimeMs*/);
+	NumberSubscriber numberSubscriberC("NumberSubscriber C", 2 /*priority*/, 4000 /*stackBytes*/, ARDUINO_RUNNING_CORE, 300  /*processingTimeMs*/); // A slow one.
+	NumberPublisher  numberPublisher  ("NumberPublisher",    2 /*priority*/, 4000 /*stackBytes*/, ARDUINO_RUNNING_CORE);
+}
+
+void setup()
+{
+	ESP_LOGI("checkpoint", "start of main");
+}
+
+void loop()
+{
+	vTaskDelay(1);// Nothing to do in loop - all example code runs in the threads above.
+}
@@ -0,0 +1,74 @@
+// by Marius Versteegen, 2023
+
+#pragma once
+#include <crt_CleanRTOS.h>
+
+// This file demonstrates a Topic: a single publisher broadcasts numbers to three subscribers.
+// Every number is copied into the topic only once, regardless of the amount of subscribers.
+// The slow subscriber cannot keep up. Instead of slowing down the publisher, it skips numbers,
+// which is reported by its overrun count.
+
+namespace crt
+{
+	// Shared resources.
+	extern Topic<int32_t, 8> topicNumbers;
+
+	class NumberSubscriber : public Task
+	{
+	private:
+		Topic<int32_t, 8>::Subscriber subscriberNumbers;
+		uint32_t processingTimeMs;
+
+	public:
+		NumberSubscriber(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber, uint32_t processingTimeMs) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), subscriberNumbers(this, topicNumbers), processingTimeMs(processingTimeMs)
+		{
+			start();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			int32_t number = 0;
+			while (true)
+			{
+				dumpStackHighWaterMarkIfIncreased(); 		// This function call takes about 0.25ms! It should be called while debugging only.
+
+				wait(subscriberNumbers);
+				subscriberNumbers.read(number);
+				ESP_LOGI(Task::taskName, "number: %d, overruns: %u", number, subscriberNumbers.getOverrunCount());
+
+				if (processingTimeMs > 0)
+				{
+					vTaskDelay(processingTimeMs);
+				}
+			}
+		}
+	}; // end class NumberSubscriber
+
+	class NumberPublisher : public Task
+	{
+	public:
+		NumberPublisher(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber)
+		{
+			start();
+		}
+
+	private:
+		/*override keyword not supported*/
+		void main()
+		{
+			vTaskDelay(1000); // wait for other threads to have started up as well.
+
+			int32_t i = 0;
+			while (true)
+			{
+				dumpStackHighWaterMarkIfIncreased();
+				topicNumbers.publish(i++);					// A single publish wakes up all subscribers.
+				vTaskDelay(100);
+			}
+		}
+	}; // end class NumberPublisher
+};// end namespace crt
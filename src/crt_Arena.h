@@ -0,0 +1,97 @@
+// by Marius Versteegen, 2023
+
+// An Arena is a bump allocator for a single task. It is meant for memory that is needed
+// during one cycle of the task (like a frame, or the handling of a message), and that can
+// be released all at once at the end of it.
+//
+//   Arena<2048> arenaFrame;                             // Member of the task.
+//
+//   while (true)                                        // Within the main of the task.
+//   {
+//       wait(..);
+//       Point* arPoints = arenaFrame.allocateArray<Point>(nofPoints);
+//       ..
+//       arenaFrame.reset();                             // Releases everything at once.
+//   }
+//
+// Allocating just moves a pointer: there is no lock, and no fragmentation can build up.
+// The memory is part of the Arena itself, so it doesn't come from the heap at all.
+//
+// Notes:
+//   * An Arena is not thread safe: it should only be used by the task that owns it.
+//   * reset() doesn't call destructors. Only create objects that don't need them.
+//   * allocate returns nullptr if the arena is full. Use getHighWaterMark to size it.
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <assert.h>
+#include <new>
+#include <utility>
+
+namespace crt
+{
+	template<size_t SIZE> class Arena
+	{
+	private:
+		alignas(8) uint8_t arBytes[SIZE];
+		size_t nofBytesUsed;
+		size_t highWaterMark;
+
+	public:
+		Arena() : nofBytesUsed(0), highWaterMark(0)
+		{}
+
+		// alignment should be a power of 2, not larger than 8.
+		void* allocate(size_t nofBytes, size_t alignment = 8)
+		{
+			assert((alignment <= 8) && ((alignment & (alignment - 1)) == 0));
+			size_t start = (nofBytesUsed + alignment - 1) & ~(alignment - 1);
+			if ((start > SIZE) || (nofBytes > SIZE - start))	// (start + nofBytes could wrap around)
+			{
+				return nullptr;
+			}
+			nofBytesUsed = start + nofBytes;
+			if (nofBytesUsed > highWaterMark)
+			{
+				highWaterMark = nofBytesUsed;
+			}
+			return &arBytes[start];
+		}
+
+		template<class T, class... ARGS> T* create(ARGS&&... args)
+		{
+			void* p = allocate(sizeof(T), alignof(T));
+			return (p == nullptr) ? nullptr : new (p) T(::std::forward<ARGS>(args)...);
+		}
+
+		template<class T> T* allocateArray(size_t nofItems)
+		{
+			T* arItems = (T*)allocate(sizeof(T) * nofItems, alignof(T));
+			if (arItems != nullptr)
+			{
+				for (size_t i = 0; i < nofItems; i++)
+				{
+					new (&arItems[i]) T();	// (An array placement new could need extra room for a count)
+				}
+			}
+			return arItems;
+		}
+
+		void reset()
+		{
+			nofBytesUsed = 0;
+		}
+
+		size_t getNofBytesUsed()
+		{
+			return nofBytesUsed;
+		}
+
+		// The maximum number of bytes that were in use at once.
+		size_t getHighWaterMark()
+		{
+			return highWaterMark;
+		}
+	};
+};
@@ -0,0 +1,207 @@
+// by Marius Versteegen, 2023
+
+// A BlockPool is an allocator for blocks of a fixed size. It is meant to replace new/malloc
+// for objects that are created and destroyed all the time, like messages that are passed
+// (by pointer) via a Queue:
+//
+//   BlockPool<sizeof(Message), 32> poolMessages;        // Typically defined in main.cpp (or .ino)
+//
+//   Message* pMessage = poolMessages.create<Message>(..);   // By the producing task.
+//   queueMessages.write(pMessage);
+//
+//   queueMessages.read(pMessage);                       // By the consuming task.
+//   ..
+//   poolMessages.destroy(pMessage);
+//
+// Compared to the heap:
+//   * All the blocks are part of the BlockPool itself. So it doesn't fragment over time,
+//     and it can't run out of memory because of other parts of the application.
+//   * It takes no lock. Each core has a small cache of free blocks, which is protected by
+//     masking the interrupts of that core only (see CoreLocalSection). Only if that cache is
+//     empty (or full, at deallocation), the shared free list is used. That is a lock free stack.
+//   * It can be used from interrupt handlers as well.
+// (see the Benchmarks example for a comparison with heap_caps_malloc)
+//
+// allocate returns nullptr if no block is available. Note that up to CORECACHESIZE free blocks
+// can be cached by the other core, where they can't be allocated from this core.
+
+#pragma once
+#include <atomic>
+#include <new>
+#include <utility>
+#include "internals/crt_FreeRTOS.h"
+#include "internals/crt_TaskCriticalSection.h"
+
+namespace crt
+{
+	template<size_t BLOCKSIZE, uint32_t NOFBLOCKS, uint32_t CORECACHESIZE = 8> class BlockPool
+	{
+		static_assert((NOFBLOCKS > 0) && (NOFBLOCKS < 0xFFFF), "The blocks of a BlockPool are indexed by 16 bits");
+
+	private:
+		static const uint32_t emptyIndex = 0xFFFF;
+
+		// Each free block contains the index of the next free block.
+		static const size_t blockStride = ((BLOCKSIZE < sizeof(uint16_t) ? sizeof(uint16_t) : BLOCKSIZE) + 7) & ~(size_t)7;
+
+		struct CoreCache
+		{
+			uint16_t arIndices[CORECACHESIZE];
+			uint32_t nofIndices;
+		};
+
+		alignas(8) uint8_t arBytes[blockStride * NOFBLOCKS];
+
+		// The head of the shared free list. The lower 16 bits contain the index of the first free block.
+		// The upper 16 bits are a tag that changes with every update. Without it, a compare-exchange
+		// could succeed on a head that has been popped and pushed again in the meantime (the ABA problem).
+		::std::atomic<uint32_t> freeListHead;
+
+		CoreCache arCoreCaches[portNUM_PROCESSORS];
+
+		::std::atomic<uint32_t> nofBlocksInUse;
+		::std::atomic<uint32_t> highWaterMark;
+		::std::atomic<uint32_t> nofFailedAllocations;
+
+	public:
+		BlockPool() : freeListHead(0), arCoreCaches(), nofBlocksInUse(0), highWaterMark(0), nofFailedAllocations(0)
+		{
+			for (uint32_t i = 0; i < NOFBLOCKS; i++)
+			{
+				nextOf(i) = (i + 1 < NOFBLOCKS) ? (uint16_t)(i + 1) : (uint16_t)emptyIndex;
+			}
+		}
+
+		// Returns nullptr if no block is available.
+		void* allocate()
+		{
+			uint32_t index = emptyIndex;
+			{
+				CoreLocalSection cls;	// Now, this task can't be switched out, or moved to the other core.
+				CoreCache& coreCache = arCoreCaches[xPortGetCoreID()];
+				if (coreCache.nofIndices > 0)
+				{
+					index = coreCache.arIndices[--coreCache.nofIndices];
+				}
+			}
+			if (index == emptyIndex)
+			{
+				index = pop();
+				if (index == emptyIndex)
+				{
+					nofFailedAllocations.fetch_add(1);
+					return nullptr;
+				}
+			}
+			updateHighWaterMark(nofBlocksInUse.fetch_add(1) + 1);
+			return blockAt(index);
+		}
+
+		void deallocate(void* pBlock)
+		{
+			uint32_t index = indexOf(pBlock);
+			nofBlocksInUse.fetch_sub(1);
+			{
+				CoreLocalSection cls;
+				CoreCache& coreCache = arCoreCaches[xPortGetCoreID()];
+				if (coreCache.nofIndices < CORECACHESIZE)
+				{
+					coreCache.arIndices[coreCache.nofIndices++] = (uint16_t)index;
+					return;
+				}
+			}
+			push(index);
+		}
+
+		template<class T, class... ARGS> T* create(ARGS&&... args)
+		{
+			static_assert(sizeof(T) <= BLOCKSIZE, "T doesn't fit in a block");
+			static_assert(alignof(T) <= 8, "T needs a larger alignment than a block has");
+			void* pBlock = allocate();
+			return (pBlock == nullptr) ? nullptr : new (pBlock) T(::std::forward<ARGS>(args)...);
+		}
+
+		// Like delete, accepts a nullptr (for instance the result of a failed create).
+		template<class T> void destroy(T* pItem)
+		{
+			if (pItem == nullptr)
+			{
+				return;
+			}
+			pItem->~T();
+			deallocate(pItem);
+		}
+
+		uint32_t getNofBlocksInUse()
+		{
+			return nofBlocksInUse.load();
+		}
+
+		// The maximum number of blocks that were in use at once.
+		uint32_t getHighWaterMark()
+		{
+			return highWaterMark.load();
+		}
+
+		uint32_t getNofFailedAllocations()
+		{
+			return nofFailedAllocations.load();
+		}
+
+	private:
+		inline void* blockAt(uint32_t index)
+		{
+			return &arBytes[index * blockStride];
+		}
+
+		inline uint32_t indexOf(void* pBlock)
+		{
+			size_t offset = (size_t)((uint8_t*)pBlock - arBytes);
+			assert((offset < sizeof(arBytes)) && ((offset % blockStride) == 0));	// The block should come from this pool.
+			return (uint32_t)(offset / blockStride);
+		}
+
+		inline uint16_t& nextOf(uint32_t index)
+		{
+			return *(uint16_t*)blockAt(index);
+		}
+
+		uint32_t pop()
+		{
+			uint32_t head = freeListHead.load();
+			while (true)
+			{
+				uint32_t index = head & 0xFFFF;
+				if (index == emptyIndex)
+				{
+					return emptyIndex;
+				}
+				// If another task popped this block in the meantime, next may be garbage.
+				// But then the tag has changed, and the compare-exchange fails.
+				uint32_t newHead = ((head + 0x10000) & 0xFFFF0000) | nextOf(index);
+				if (freeListHead.compare_exchange_weak(head, newHead))
+				{
+					return index;
+				}
+			}
+		}
+
+		void push(uint32_t index)
+		{
+			uint32_t head = freeListHead.load();
+			uint32_t newHead = 0;
+			do
+			{
+				nextOf(index) = (uint16_t)(head & 0xFFFF);
+				newHead = ((head + 0x10000) & 0xFFFF0000) | index;
+			} while (!freeListHead.compare_exchange_weak(head, newHead));
+		}
+
+		inline void updateHighWaterMark(uint32_t nofBlocksInUseNow)
+		{
+			uint32_t oldHighWaterMark = highWaterMark.load();
+			while ((nofBlocksInUseNow > oldHighWaterMark) && !highWaterMark.compare_exchange_weak(oldHighWaterMark, nofBlocksInUseNow))
+			{}
+		}
+	};
+};
@@ -0,0 +1,158 @@
+// by Marius Versteegen, 2023
+
+// A BroadcastFlag is a Flag that can be waited for by multiple tasks.
+// A Flag belongs to a single task. To signal the same event to multiple tasks, a separate
+// Flag per task would be needed, each with a set() call of its own.
+// Instead, every receiving task owns a BroadcastFlag::Subscriber (a waitable, that behaves
+// like a Flag), and a single set() of the BroadcastFlag sets all of them.
+//
+//   BroadcastFlag<> flagStartFrame;                          // Typically defined in main.cpp (or .ino)
+//
+//   BroadcastFlag<>::Subscriber subscriberStartFrame;        // Member of a receiving task,
+//   subscriberStartFrame(this, flagStartFrame)               // initialised in its constructor.
+//
+//   wait(subscriberStartFrame);                              // Within the main of the receiving task.
+//
+//   flagStartFrame.set();                                    // From any task.
+//
+// Built on it:
+//   CountdownLatch - Fires (once) when countDown() has been called count times.
+//                    For instance, to wait till a number of tasks have finished their initialisation.
+//   Barrier        - For fork-join phases: fires each time all nofParticipants have called arrive().
+//                    Then, it starts counting again for the next phase.
+//
+// CountdownLatch and Barrier only fire by counting, so they don't offer set(). They have a
+// Subscriber of their own, that is used the same way: CountdownLatch<>::Subscriber.
+//
+// Each task still has its own event group, so set() costs one event group call per subscriber.
+// (see the Benchmarks example for the wake-all latency)
+
+#pragma once
+#include <atomic>
+#include "internals/crt_FreeRTOS.h"
+#include "internals/crt_SimpleMutex.h"
+#include "crt_Waitable.h"
+#include "crt_Task.h"
+
+namespace crt
+{
+	template<uint32_t MAXSUBSCRIBERS = 8> class BroadcastFlag
+	{
+	public:
+		class Subscriber : public Waitable
+		{
+			friend class BroadcastFlag;
+
+		private:
+			Task* pTask;
+
+		public:
+			Subscriber(Task* pTask, BroadcastFlag& broadcastFlag) : Waitable(WaitableType::wt_Flag), pTask(pTask)
+			{
+				Waitable::init(pTask->queryBitNumber(this));
+				broadcastFlag.subscribe(this);
+			}
+
+			void clear()
+			{
+				pTask->clearEventBits(Waitable::getBitMask());
+			}
+		};
+
+	private:
+		Subscriber* arSubscribers[MAXSUBSCRIBERS] = {};
+		uint32_t nofSubscribers;
+		SimpleMutex simpleMutex;	// No deadlock risk: no other mutexes are locked while it is held.
+
+	public:
+		BroadcastFlag() : nofSubscribers(0)
+		{}
+
+		// Sets the flags of all subscribers.
+		void set()
+		{
+			simpleMutex.lock();
+			for (uint32_t i = 0; i < nofSubscribers; i++)
+			{
+				Subscriber* pSubscriber = arSubscribers[i];
+				pSubscriber->pTask->setEventBits(pSubscriber->getBitMask());
+			}
+			simpleMutex.unlock();
+		}
+
+	private:
+		void subscribe(Subscriber* pSubscriber)
+		{
+			simpleMutex.lock();
+			assert(nofSubscribers < MAXSUBSCRIBERS);
+			arSubscribers[nofSubscribers++] = pSubscriber;
+			simpleMutex.unlock();
+		}
+	};
+
+	template<uint32_t MAXSUBSCRIBERS = 8> class CountdownLatch : private BroadcastFlag<MAXSUBSCRIBERS>
+	{
+	private:
+		::std::atomic<int32_t> count;
+
+	public:
+		class Subscriber : public BroadcastFlag<MAXSUBSCRIBERS>::Subscriber
+		{
+		public:
+			Subscriber(Task* pTask, CountdownLatch& latch) : BroadcastFlag<MAXSUBSCRIBERS>::Subscriber(pTask, latch)
+			{}
+		};
+
+		CountdownLatch(int32_t count) : count(count)
+		{}
+
+		// The subscribers fire when the count reaches zero.
+		void countDown()
+		{
+			if (count.fetch_sub(1) == 1)
+			{
+				BroadcastFlag<MAXSUBSCRIBERS>::set();
+			}
+		}
+
+		int32_t getCount()
+		{
+			return count.load();
+		}
+
+		// Re-arms the latch. Should only be called after it has fired.
+		void reset(int32_t newCount)
+		{
+			count.store(newCount);
+		}
+	};
+
+	template<uint32_t MAXSUBSCRIBERS = 8> class Barrier : private BroadcastFlag<MAXSUBSCRIBERS>
+	{
+	private:
+		const int32_t nofParticipants;
+		::std::atomic<int32_t> nofArrivalsLeft;
+
+	public:
+		class Subscriber : public BroadcastFlag<MAXSUBSCRIBERS>::Subscriber
+		{
+		public:
+			Subscriber(Task* pTask, Barrier& barrier) : BroadcastFlag<MAXSUBSCRIBERS>::Subscriber(pTask, barrier)
+			{}
+		};
+
+		Barrier(int32_t nofParticipants) : nofParticipants(nofParticipants), nofArrivalsLeft(nofParticipants)
+		{}
+
+		// Each participant calls arrive() when it has finished the current phase, and
+		// then waits for its Subscriber. The last one to arrive makes all of them fire.
+		void arrive()
+		{
+			if (nofArrivalsLeft.fetch_sub(1) == 1)
+			{
+				nofArrivalsLeft.store(nofParticipants);	// Before the others can arrive for the next phase.
+				BroadcastFlag<MAXSUBSCRIBERS>::set();
+			}
+		}
+	};
+};
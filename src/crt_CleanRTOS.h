@@ -16,19 +16,30 @@
 #include "crt_Task.h"
 #include "crt_Flag.h"
 #include "crt_Queue.h"
+#include "crt_Semaphore.h"
+#include "crt_PriorityQueue.h"
+#include "crt_Mailbox.h"
+#include "crt_Topic.h"
+#include "crt_BroadcastFlag.h"
 #include "crt_Timer.h"
+#include "crt_TokenBucket.h"
 #include "crt_Pool.h"
+#include "crt_RwPool.h"
+#include "crt_BlockPool.h"
+#include "crt_Arena.h"
 #include "crt_IHandler.h"
 #include "crt_IHandlerListener.h"
 
-// crt_Logger, crt_Handler, crt_MutexSection, crt_Mutex and crt_Handler are to
-// be included separately, if needed.
+// crt_Logger, crt_Handler, crt_StaticHandler, crt_StateMachineTask, crt_MutexSection, crt_Mutex and crt_CoScheduler
+// are to be included separately, if needed.
 //
 // Reasons:
 //    * Logger should never be needed outside main.cpp (or .ino)). 
 //      ILogger should be used everywhere else instead.
 //    * Handler should never be needed outside main.cpp (or .ino))
 //      IHandler should be used everywhere else instead.
+//      The same goes for StaticHandler and StateMachineTask.
+//    * CoScheduler needs C++20.
 //    * Mutex should never be needed outside main.cpp (or .ino)),
 //      to keep a good overview of the assignment and order of mutex ids.
 //		Also, Mutex should not be used stand-alone, as that is error prone.
@@ -0,0 +1,350 @@
+// by Marius Versteegen, 2023
+
+// A CoScheduler is a Task that runs many light-weight, stackless C++20 coroutines.
+// Like with the Handler, it can be used to replace multiple tasks by a single task,
+// thereby saving a stack and an event group per replaced task.
+// Unlike with the Handler, every coroutine can simply wait for Waitables
+// (Flags, Queues and Timers that are owned by the CoScheduler), as if it were
+// a Task of its own:
+//
+//   Coroutine blinker(Flag& flagStart)
+//   {
+//       co_await flagStart;             // like wait(flagStart);
+//       while (true)
+//       {
+//           co_await coSleep_us(500000);// like vTaskDelay(500), but without blocking the other coroutines.
+//           ...
+//       }
+//   }
+//
+//   Other ways to wait:
+//       co_await queue;   queue.read(number);        // like wait(queue); queue.read(number);
+//       uint32_t firedBits = co_await coWaitAny(flag1 + queue1);
+//       if (firedBits & flag1) { ... }               // like waitAny(flag1 + queue1); if(hasFired(flag1)) ..
+//
+// Coroutines are added by calling spawn(). That may be done from any task, at any time.
+//
+// Notes:
+//   * Only Waitables that are owned by the CoScheduler itself can be waited for.
+//   * Each Waitable should be waited for by a single coroutine at a time.
+//   * Sleeps via coSleep_us cost no Timer (and no event bit): all of them share
+//     a single Timer of the CoScheduler.
+//   * A coroutine should never block (for instance by vTaskDelay or a blocking Queue::read)
+//     because that would block all other coroutines of the same CoScheduler as well.
+//   * Coroutines need C++20. (For gcc: compile with -std=gnu++20 or -fcoroutines)
+//     If the compiler does not support them, this file compiles to nothing.
+
+// (see the Coroutines example in the examples folder)
+
+#pragma once
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#include "internals/crt_FreeRTOS.h"
+#include "crt_Task.h"
+#include "crt_Queue.h"
+#include "crt_Timer.h"
+
+namespace crt
+{
+	// The CoScheduler as seen from within its coroutines.
+	class ICoScheduler
+	{
+	public:
+		virtual void parkUntilAny(uint32_t slotIndex, uint32_t bitsToWaitFor) = 0;
+		virtual void parkUntilTime(uint32_t slotIndex, uint64_t wakeTimeUs) = 0;
+		virtual uint32_t getFiredBits(uint32_t slotIndex) = 0;
+	};
+
+	// Coroutine is the return type of every function that is to be run by a CoScheduler.
+	class Coroutine
+	{
+	public:
+		struct promise_type
+		{
+			ICoScheduler* pCoScheduler = nullptr;
+			uint32_t slotIndex = 0;
+
+			Coroutine get_return_object() { return Coroutine(::std::coroutine_handle<promise_type>::from_promise(*this)); }
+			::std::suspend_always initial_suspend() noexcept { return {}; }	// The CoScheduler starts it, within its own task.
+			::std::suspend_always final_suspend() noexcept { return {}; }	// The CoScheduler destroys it.
+			void return_void() {}
+			void unhandled_exception() { assert(false); }
+		};
+
+		using Handle = ::std::coroutine_handle<promise_type>;
+
+	private:
+		Handle handle;
+
+	public:
+		explicit Coroutine(Handle handle) : handle(handle)
+		{}
+
+		Coroutine(Coroutine&& other) : handle(other.handle)
+		{
+			other.handle = nullptr;
+		}
+
+		Coroutine(const Coroutine&) = delete;
+		Coroutine& operator=(const Coroutine&) = delete;
+
+		~Coroutine()
+		{
+			if (handle)
+			{
+				handle.destroy();	// Never spawned.
+			}
+		}
+
+		// Hands over the ownership of the coroutine (to the CoScheduler).
+		Handle release()
+		{
+			Handle result = handle;
+			handle = nullptr;
+			return result;
+		}
+	};
+
+	// Awaiting the return value of coWaitAny suspends the coroutine till any of the
+	// specified waitables has fired. The result is the bits that fired.
+	class CoWaitAny
+	{
+	private:
+		uint32_t bitsToWaitFor;
+		Coroutine::Handle handle;
+
+	public:
+		CoWaitAny(uint32_t bitsToWaitFor) : bitsToWaitFor(bitsToWaitFor), handle(nullptr)
+		{}
+
+		bool await_ready() { return false; }
+
+		void await_suspend(Coroutine::Handle handle)
+		{
+			this->handle = handle;
+			handle.promise().pCoScheduler->parkUntilAny(handle.promise().slotIndex, bitsToWaitFor);
+		}
+
+		uint32_t await_resume()
+		{
+			return handle.promise().pCoScheduler->getFiredBits(handle.promise().slotIndex);
+		}
+	};
+
+	// Awaiting the return value of coSleep_us suspends the coroutine for the specified duration.
+	class CoSleep
+	{
+	private:
+		uint64_t duration_us;
+
+	public:
+		CoSleep(uint64_t duration_us) : duration_us(duration_us)
+		{}
+
+		bool await_ready() { return false; }
+
+		void await_suspend(Coroutine::Handle handle)
+		{
+			handle.promise().pCoScheduler->parkUntilTime(handle.promise().slotIndex, esp_timer_get_time() + duration_us);
+		}
+
+		void await_resume() {}
+	};
+
+	inline CoWaitAny coWaitAny(uint32_t bitsToWaitFor)
+	{
+		return CoWaitAny(bitsToWaitFor);
+	}
+
+	inline CoSleep coSleep_us(uint64_t duration_us)
+	{
+		return CoSleep(duration_us);
+	}
+
+	// Allows: co_await flag; co_await queue; co_await timer;
+	inline CoWaitAny operator co_await(Waitable& waitable)
+	{
+		return CoWaitAny(waitable.getBitMask());
+	}
+
+	template<unsigned int MAXCOROUTINES> class CoScheduler : public Task, public ICoScheduler
+	{
+	private:
+		static const uint64_t noWakeTime = UINT64_MAX;
+		static const uint64_t minSleepUs = 50;	// Shorter sleeps than this are not worth a timer start.
+
+		struct Slot
+		{
+			Coroutine::Handle handle;
+			uint32_t bitsToWaitFor;
+			uint32_t firedBits;
+			uint64_t wakeTimeUs;
+		};
+
+		Slot arSlots[MAXCOROUTINES] = {};
+		uint32_t nofCoroutines;
+
+		Queue<void*, MAXCOROUTINES> queueSpawn;	// The addresses of the coroutine handles that are to be added.
+		Timer wakeTimer;						// Shared by all sleeping coroutines.
+
+	public:
+		CoScheduler(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), nofCoroutines(0), queueSpawn(this), wakeTimer(this)
+		{
+			start();
+		}
+
+		// Hands the coroutine over to this CoScheduler, which will start it.
+		// Can be called from any task.
+		// Returns false if it could not be added (too many coroutines pending for spawning).
+		bool spawn(Coroutine&& coroutine)
+		{
+			void* address = coroutine.release().address();
+			bool bResult = queueSpawn.write(address);
+			if (!bResult)
+			{
+				Coroutine::Handle::from_address(address).destroy();
+			}
+			return bResult;
+		}
+
+		uint32_t getNofCoroutines()
+		{
+			return nofCoroutines;
+		}
+
+		/*override keyword not supported in current compiler*/
+		void parkUntilAny(uint32_t slotIndex, uint32_t bitsToWaitFor)
+		{
+			arSlots[slotIndex].bitsToWaitFor = bitsToWaitFor;
+		}
+
+		/*override keyword not supported in current compiler*/
+		void parkUntilTime(uint32_t slotIndex, uint64_t wakeTimeUs)
+		{
+			arSlots[slotIndex].wakeTimeUs = wakeTimeUs;
+		}
+
+		/*override keyword not supported in current compiler*/
+		uint32_t getFiredBits(uint32_t slotIndex)
+		{
+			return arSlots[slotIndex].firedBits;
+		}
+
+	private:
+		void addSpawnedCoroutines()
+		{
+			// The queue keeps its own bit set while it contains spawns, so just drain it.
+			void* address = nullptr;
+			while (queueSpawn.tryRead(address))
+			{
+				for (uint32_t i = 0; i < MAXCOROUTINES; i++)
+				{
+					if (!arSlots[i].handle)
+					{
+						Coroutine::Handle handle = Coroutine::Handle::from_address(address);
+						handle.promise().pCoScheduler = this;
+						handle.promise().slotIndex = i;
+						arSlots[i].handle = handle;
+						nofCoroutines++;
+						resume(i);	// Run it till its first co_await.
+						address = nullptr;
+						break;
+					}
+				}
+				assert(address == nullptr);	// More than MAXCOROUTINES coroutines alive.
+			}
+		}
+
+		void resume(uint32_t slotIndex)
+		{
+			Slot& slot = arSlots[slotIndex];
+			slot.bitsToWaitFor = 0;
+			slot.wakeTimeUs = noWakeTime;
+			slot.handle.resume();
+
+			if (slot.handle.done())
+			{
+				slot.handle.destroy();
+				slot.handle = nullptr;
+				nofCoroutines--;
+			}
+		}
+
+		void main()
+		{
+			while (true)
+			{
+				dumpStackHighWaterMarkIfIncreased();
+
+				// Determine what to wait for: the union of everything the coroutines wait for.
+				uint32_t bitsToWaitFor = queueSpawn.getBitMask();
+				uint64_t earliestWakeTimeUs = noWakeTime;
+				for (uint32_t i = 0; i < MAXCOROUTINES; i++)
+				{
+					if (arSlots[i].handle)
+					{
+						bitsToWaitFor |= arSlots[i].bitsToWaitFor;
+						if (arSlots[i].wakeTimeUs < earliestWakeTimeUs)
+						{
+							earliestWakeTimeUs = arSlots[i].wakeTimeUs;
+						}
+					}
+				}
+
+				uint32_t firedBits = 0;
+				bool bSleepersDue = false;
+				if (earliestWakeTimeUs != noWakeTime)
+				{
+					uint64_t nowUs = esp_timer_get_time();
+					if (earliestWakeTimeUs < nowUs + minSleepUs)
+					{
+						bSleepersDue = true;
+					}
+					else
+					{
+						wakeTimer.start(earliestWakeTimeUs - nowUs);
+						bitsToWaitFor |= wakeTimer.getBitMask();
+					}
+				}
+
+				if (!bSleepersDue)
+				{
+					firedBits = waitAny(bitsToWaitFor) & bitsToWaitFor;
+
+					// Consume all fired events at once, except for the queue events (those are consumed by reading).
+					clearEventBits(firedBits & ~queuesMask);
+				}
+
+				if (firedBits & queueSpawn.getBitMask())
+				{
+					addSpawnedCoroutines();
+				}
+
+				// Resume every coroutine of which the wait is over.
+				uint64_t nowUs = esp_timer_get_time();
+				uint32_t bitsNotHandledYet = firedBits & ~(queueSpawn.getBitMask() | wakeTimer.getBitMask());
+				for (uint32_t i = 0; i < MAXCOROUTINES; i++)
+				{
+					Slot& slot = arSlots[i];
+					if (!slot.handle)
+					{
+						continue;
+					}
+
+					slot.firedBits = bitsNotHandledYet & slot.bitsToWaitFor;
+					if (slot.firedBits != 0)
+					{
+						bitsNotHandledYet &= ~slot.firedBits;	// Each event is handled by a single coroutine.
+						resume(i);
+					}
+					else if (slot.wakeTimeUs <= nowUs + minSleepUs)
+					{
+						resume(i);
+					}
+				}
+			}
+		}
+	}; // end class CoScheduler
+}; // end namespace crt
+#endif
@@ -6,12 +6,25 @@
 #pragma once
 #define CRT_DEBUG_LOGGING
 #define CRT_HIGH_WATERMARK_INCREASE_LOGGING
+#define CRT_MUTEX_ORDER_CHECKING    // Runtime check of the mutex locking order (see crt_Mutex.h). 
+                                    // OrderedMutexSections are checked at compile time as well.
+// #define CRT_MUTEX_PROFILING      // Per Mutex contention statistics (see MutexProfiler in crt_Mutex.h).
 // #define ARDUINO_RUNNING_CORE 1  already defined in sdkconfig
 
 namespace crt
 {
 	const uint32_t MAX_MUTEXNESTING = 20;
 
+	// The amount of times an AdaptiveMutex (used by Mutex) polls whether a holder on the
+	// other core has released it, before it falls back to a blocking wait.
+	const uint32_t ADAPTIVE_MUTEX_SPINCOUNT = 200;
+
+	// The LOGSIZE of the DefaultLogger (see crt_Logger.h).
+	const unsigned int DEFAULTLOGGER_LOGSIZE = 100;
+
+	// The maximum amount of Mutexes of which statistics are kept if CRT_MUTEX_PROFILING is defined.
+	const uint32_t MAX_PROFILED_MUTEXES = 32;
+
 	// below, the mutexIDs directly involved in this test can be found.
 	const uint32_t MutexID_Logger = (1 << 30);	// High ID, so can be nested very deeply.
 };
\ No newline at end of file
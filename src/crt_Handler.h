@@ -2,8 +2,12 @@
 #include "internals/crt_FreeRTOS.h"
 #include "crt_ILogger.h"
 #include "crt_Task.h"
+#include "crt_Flag.h"
+#include "crt_Queue.h"
 #include "crt_IHandler.h"
 #include "crt_IHandlerListener.h"
+#include "internals/crt__std_PointerSet.h"
+#include <atomic>
 
 // by Marius Versteegen, 2023
 
@@ -13,10 +17,28 @@
 // For that end, the handler task periodically calls update() member functions of the 
 // objects that originally had their own task.
 
+// Listeners that only need to act upon an event, can be added together with a Flag, Queue 
+// or Timer (owned by the handler task, see IHandler::getTask()). Their update() function is
+// only called when that waitable has fired. In between the periods, the handler waits for
+// the waitables of all those listeners at once.
+// If all listeners are event driven, the handler doesn't wake up periodically at all.
+
 // (see the Handler example in the examples folder)
 
-// NOTE: a Handler task must be started manually after its listeners have been added,
-// by calling its start() member function.
+// Periodic listeners can be given a priority and a deadline (in us, relative to the start of
+// the period). Within each period, the listeners are updated earliest deadline first (listeners
+// without deadline last), and with equal deadlines, highest priority first.
+// If a frame budget is specified, listeners with a priority below minPriorityUnderOverload
+// are skipped for the rest of the period once the budget is used up, so that the critical 
+// ones keep their timing under overload. The skips and deadline misses are counted per listener.
+
+// Listeners can be added and removed at any time, from any task (also from within update()).
+// Those requests are queued, and carried out by the handler task itself, in between updates.
+// Thus, the update() of a removed listener may still be called once more, till then.
+// Before destroying a removed listener, wait for the Flag that the handler sets once it is done
+// with it (see IHandler::removeHandlerListener).
+// Requests that can't be carried out (more than MAXLISTENERCOUNT listeners, or more than
+// MAXLISTENERCOUNT removals pending) are refused right away: the call then returns false.
 
 // This Handler class assumes that 1 tick equals 1ms.
 // Within the ArduinoIDE, that's the default already.
@@ -35,12 +57,42 @@ namespace crt
 	private: 
 		const uint64_t infiniteBatchSizeUs = 1000000000000; // 1e6 s means: infinite: no limitation in batchsize.
 
+		struct ListenerCommand
+		{
+			IHandlerListener* pHandlerListener;
+			uint32_t bitMask;	// The bit of its waitable, or 0 for a periodic listener.
+			uint32_t deadlineUs;
+			uint8_t priority;
+			bool bRemove;
+			Flag* pFlagRemoved;	// Set after the removal, if not nullptr.
+		};
+
+		struct ListenerInfo
+		{
+			IHandlerListener* pHandlerListener;
+			uint32_t bitMask;			// The bit of its waitable, or 0 for a periodic listener.
+			uint32_t deadlineUs;		// Relative to the start of the period. 0 : no deadline.
+			uint8_t priority;
+			uint32_t nofSkipped;		// Updates skipped because the frame budget was used up.
+			uint32_t nofDeadlineMisses;	// Updates that finished after the deadline.
+		};
+
 		// that converts LOGSIZE to stackSize in the initializer list of the constructor.
-		IHandlerListener* arHandlerListener[MAXLISTENERCOUNT] = {};
+		ListenerInfo arListeners[MAXLISTENERCOUNT] = {};	// In order of registration.
+		uint16_t arOrder[MAXLISTENERCOUNT] = {};			// Indices into arListeners, in order of execution.
 		uint16_t nofHandlerListeners;
+		uint16_t nofPeriodicHandlerListeners;
+		uint32_t eventBitsToWaitFor;	// The union of the bits of all event driven listeners.
+		std::PointerSet<IHandlerListener, MAXLISTENERCOUNT> setHandlerListeners;	// For O(1) duplicate checks.
+		Queue<ListenerCommand, 2 * MAXLISTENERCOUNT> queueListenerCommands;	// Requests to add or remove listeners.
+		::std::atomic<uint32_t> nofReservedListeners;	// Listeners that are added or have an add request pending.
+		::std::atomic<uint32_t> nofPendingRemovals;		// Together, they bound the number of pending requests.
 		uint16_t periodMs;
 		uint64_t periodUs;
 		uint64_t batchSizeUs;
+		uint64_t frameBudgetUs;
+		uint8_t minPriorityUnderOverload;
+		bool bTimingNeeded;		// Whether the time needs to be checked after each update.
 
 	public:
 		Handler(const char* taskName, unsigned int taskPriority, unsigned int taskCoreNumber, uint16_t periodMs) :
@@ -51,32 +103,258 @@ namespace crt
 		// batchSizeUs : if a series of consequtive update() calls exceeds batchSizeUs,
 		//               a task yield is inserted.
 		Handler(const char *taskName, unsigned int taskPriority, unsigned int taskCoreNumber, uint16_t periodMs, uint64_t batchSizeUs) :
-			Task(taskName, taskPriority, 5500 + MAXLISTENERCOUNT * sizeof(IHandlerListener*), taskCoreNumber), nofHandlerListeners(0), periodMs(periodMs), periodUs(periodMs*1000), batchSizeUs(batchSizeUs)// assert period.
+			Handler(taskName, taskPriority, taskCoreNumber, periodMs, batchSizeUs, periodMs*1000 /* by default, the whole period */, 0 /* never skip */)
+		{
+		}
+
+		// frameBudgetUs : once the periodic updates of a period have taken longer than frameBudgetUs,
+		//                 the listeners with a priority below minPriorityUnderOverload are skipped
+		//                 for the rest of that period.
+		Handler(const char *taskName, unsigned int taskPriority, unsigned int taskCoreNumber, uint16_t periodMs, uint64_t batchSizeUs,
+		        uint64_t frameBudgetUs, uint8_t minPriorityUnderOverload) :
+			Task(taskName, taskPriority, 5500 + MAXLISTENERCOUNT * sizeof(IHandlerListener*), taskCoreNumber), nofHandlerListeners(0), nofPeriodicHandlerListeners(0), eventBitsToWaitFor(0), queueListenerCommands(this), nofReservedListeners(0), nofPendingRemovals(0), periodMs(periodMs), periodUs(periodMs*1000), batchSizeUs(batchSizeUs),
+			frameBudgetUs(frameBudgetUs), minPriorityUnderOverload(minPriorityUnderOverload), bTimingNeeded(false)// assert period.
 		{
 			start();
 		}
 
 		/*override keyword not supported in current compiler*/
-		void addHandlerListener(IHandlerListener* pHandlerListener)
+		bool addHandlerListener(IHandlerListener* pHandlerListener)
 		{
-			if (!isAlreadyPresent(pHandlerListener))
-			{	
-				assert(nofHandlerListeners < MAXLISTENERCOUNT);
-				arHandlerListener[nofHandlerListeners++] = pHandlerListener;
-			}
+			return queueAddCommand(pHandlerListener, 0, 0, 0);
+		}
+
+		/*override keyword not supported in current compiler*/
+		bool addHandlerListener(IHandlerListener* pHandlerListener, Waitable& waitable)
+		{
+			return queueAddCommand(pHandlerListener, waitable.getBitMask(), 0, 0);
+		}
+
+		/*override keyword not supported in current compiler*/
+		bool addHandlerListener(IHandlerListener* pHandlerListener, uint8_t priority, uint32_t deadlineUs)
+		{
+			return queueAddCommand(pHandlerListener, 0, priority, deadlineUs);
+		}
+
+		/*override keyword not supported in current compiler*/
+		bool removeHandlerListener(IHandlerListener* pHandlerListener)
+		{
+			return queueRemoveCommand(pHandlerListener, nullptr);
+		}
+
+		/*override keyword not supported in current compiler*/
+		bool removeHandlerListener(IHandlerListener* pHandlerListener, Flag& flagRemoved)
+		{
+			return queueRemoveCommand(pHandlerListener, &flagRemoved);
+		}
+
+		// The amount of updates of the listener that were skipped because the frame budget was used up.
+		// (Meant for diagnostics: the value can be slightly outdated)
+		uint32_t getSkippedCount(IHandlerListener* pHandlerListener)
+		{
+			ListenerInfo* pInfo = findListener(pHandlerListener);
+			return (pInfo != nullptr) ? pInfo->nofSkipped : 0;
+		}
+
+		// The amount of updates of the listener that finished after its deadline.
+		uint32_t getDeadlineMissCount(IHandlerListener* pHandlerListener)
+		{
+			ListenerInfo* pInfo = findListener(pHandlerListener);
+			return (pInfo != nullptr) ? pInfo->nofDeadlineMisses : 0;
+		}
+
+		/*override keyword not supported in current compiler*/
+		Task* getTask()
+		{
+			return this;
 		}
 
 	private:
-		bool isAlreadyPresent(IHandlerListener* pHandlerListener)
+		// A slot is reserved for each added listener already when its request is queued.
+		// That way, the handler task never runs out of slots when carrying out the requests.
+		// With at most MAXLISTENERCOUNT pending adds and removals each, the queue can't overflow either.
+		bool queueAddCommand(IHandlerListener* pHandlerListener, uint32_t bitMask, uint8_t priority, uint32_t deadlineUs)
+		{
+			if (nofReservedListeners.fetch_add(1) >= MAXLISTENERCOUNT)
+			{
+				nofReservedListeners.fetch_sub(1);
+				return false;	// More than MAXLISTENERCOUNT listeners.
+			}
+			ListenerCommand command = { pHandlerListener, bitMask, deadlineUs, priority, false, nullptr };
+			if (!queueListenerCommands.write(command))
+			{
+				nofReservedListeners.fetch_sub(1);
+				return false;
+			}
+			return true;
+		}
+
+		bool queueRemoveCommand(IHandlerListener* pHandlerListener, Flag* pFlagRemoved)
+		{
+			if (nofPendingRemovals.fetch_add(1) >= MAXLISTENERCOUNT)
+			{
+				nofPendingRemovals.fetch_sub(1);
+				return false;	// More than MAXLISTENERCOUNT removals pending.
+			}
+			ListenerCommand command = { pHandlerListener, 0, 0, 0, true, pFlagRemoved };
+			if (!queueListenerCommands.write(command))
+			{
+				nofPendingRemovals.fetch_sub(1);
+				return false;
+			}
+			return true;
+		}
+
+		// Only called by the handler task itself, in between updates.
+		void applyListenerCommands()
+		{
+			ListenerCommand command;
+			while (queueListenerCommands.tryRead(command))
+			{
+				if (command.bRemove)
+				{
+					nofPendingRemovals.fetch_sub(1);
+					removeListener(command.pHandlerListener);
+					if (command.pFlagRemoved != nullptr)
+					{
+						command.pFlagRemoved->set();
+					}
+				}
+				else
+				{
+					addListener(command);
+				}
+			}
+		}
+
+		void addListener(const ListenerCommand& command)
+		{
+			if (setHandlerListeners.contains(command.pHandlerListener))
+			{
+				nofReservedListeners.fetch_sub(1);
+				return;	// Already present.
+			}
+			setHandlerListeners.insert(command.pHandlerListener);
+			ListenerInfo info = { command.pHandlerListener, command.bitMask, command.deadlineUs, command.priority, 0, 0 };
+			arListeners[nofHandlerListeners++] = info;
+			updateOrder();
+		}
+
+		void removeListener(IHandlerListener* pHandlerListener)
 		{
+			if (!setHandlerListeners.erase(pHandlerListener))
+			{
+				return;	// Not present.
+			}
+			nofReservedListeners.fetch_sub(1);
+
+			// Keep the order of the others.
+			int j = 0;
+			for (int i = 0; i < nofHandlerListeners; i++)
+			{
+				if (arListeners[i].pHandlerListener != pHandlerListener)
+				{
+					arListeners[j++] = arListeners[i];
+				}
+			}
+			nofHandlerListeners = j;
+			updateOrder();
+		}
+
+		// Earliest deadline first (no deadline counts as the end of the period),
+		// then highest priority first, then order of registration.
+		bool goesBefore(const ListenerInfo& a, const ListenerInfo& b)
+		{
+			uint64_t deadlineA = (a.deadlineUs != 0) ? a.deadlineUs : periodUs;
+			uint64_t deadlineB = (b.deadlineUs != 0) ? b.deadlineUs : periodUs;
+			if (deadlineA != deadlineB)
+			{
+				return deadlineA < deadlineB;
+			}
+			return a.priority > b.priority;
+		}
+
+		// Called after each change of the listeners. The list is short, so insertion sort
+		// (which keeps the order of registration for equal listeners) will do.
+		void updateOrder()
+		{
+			nofPeriodicHandlerListeners = 0;
+			eventBitsToWaitFor = 0;
+			bTimingNeeded = (batchSizeUs != infiniteBatchSizeUs) || (minPriorityUnderOverload > 0);
+			for (int i = 0; i < nofHandlerListeners; i++)
+			{
+				const ListenerInfo& info = arListeners[i];
+				if (info.bitMask == 0)
+				{
+					nofPeriodicHandlerListeners++;
+				}
+				eventBitsToWaitFor |= info.bitMask;
+				bTimingNeeded |= (info.deadlineUs != 0);
+
+				int j = i;
+				while ((j > 0) && goesBefore(info, arListeners[arOrder[j - 1]]))
+				{
+					arOrder[j] = arOrder[j - 1];
+					j--;
+				}
+				arOrder[j] = i;
+			}
+		}
+
+		ListenerInfo* findListener(IHandlerListener* pHandlerListener)
+		{
+			for (int i = 0; i < nofHandlerListeners; i++)
+			{
+				if (arListeners[i].pHandlerListener == pHandlerListener)
+				{
+					return &arListeners[i];
+				}
+			}
+			return nullptr;
+		}
+
+		// Calls the listeners of which the waitable has fired.
+		void dispatchEvents(uint32_t firedBits)
+		{
+			if (firedBits & queueListenerCommands.getBitMask())
+			{
+				applyListenerCommands();
+			}
+
+			// Consume all fired events at once, except for the queue events (those are consumed by reading).
+			clearEventBits(firedBits & ~queuesMask);
 			for (int i = 0; i < nofHandlerListeners; i++)
 			{
-				if (arHandlerListener[i] == pHandlerListener)
+				const ListenerInfo& info = arListeners[arOrder[i]];
+				if ((info.bitMask & firedBits) != 0)
+				{
+					info.pHandlerListener->update();
+				}
+			}
+		}
+
+		// Instead of just sleeping till the end of the period, handle the events meanwhile.
+		void dispatchEventsUntil(uint64_t endUs)
+		{
+			while (true)
+			{
+				uint64_t nowUs = esp_timer_get_time();
+				if (nowUs >= endUs)
+				{
+					return;
+				}
+				uint32_t msLeft = (uint32_t)((endUs - nowUs) / 1000);
+				if (msLeft == 0)
+				{
+					return;
+				}
+				uint32_t firedBits = waitAny(eventBitsToWaitFor | queueListenerCommands.getBitMask(), msLeft);
+				if (firedBits == 0)
 				{
-					return true;
+					return;	// Timed out: the period is over.
 				}
+				dispatchEvents(firedBits);
 			}
-			return false;
 		}
 
 		void main()
@@ -97,9 +375,18 @@ namespace crt
 			uint64_t beforeBatch    = 0;
 			uint64_t batchTimeSpent	= 0;
 			
-			vTaskDelay(500); // wait for other objects to initialise and add themselves as handlerlistener.
+			applyListenerCommands();	// The listeners that added themselves before the handler task started.
 			while (true)
 			{
+				if (nofPeriodicHandlerListeners == 0)
+				{
+					// Purely event driven: no need to wake up periodically.
+					dispatchEvents(waitAny(eventBitsToWaitFor | queueListenerCommands.getBitMask()));
+					dumpStackHighWaterMarkIfIncreased();
+					beforeAll = esp_timer_get_time();	// In case a periodic listener has been added.
+					continue;
+				}
+
 				beforeBatch = esp_timer_get_time();
 
 #ifdef TEST_CRT_HANDLER
@@ -108,9 +395,34 @@ namespace crt
 				beforeBatches  = beforeBatch;
 #endif				
 
+				bool bOverloaded = false;
 				for (int i = 0; i < nofHandlerListeners; i++)
 				{
-					arHandlerListener[i]->update();
+					ListenerInfo& info = arListeners[arOrder[i]];
+					if (info.bitMask != 0)
+					{
+						continue;	// Event driven listener.
+					}
+					if (bOverloaded && (info.priority < minPriorityUnderOverload))
+					{
+						info.nofSkipped++;
+						continue;
+					}
+					info.pHandlerListener->update();
+
+					if (bTimingNeeded)
+					{
+						uint64_t nowUs = esp_timer_get_time();
+						uint64_t frameTimeSpent = (nowUs - beforeAll);
+						if ((info.deadlineUs != 0) && (frameTimeSpent > info.deadlineUs))
+						{
+							info.nofDeadlineMisses++;
+						}
+						if (frameTimeSpent > frameBudgetUs)
+						{
+							bOverloaded = true;
+						}
+					}
 
 					if (batchSizeUs != infiniteBatchSizeUs)
 					{
@@ -140,9 +452,7 @@ namespace crt
 					ESP_LOGI("Handler Delay too long:", "%d us", diffAll);
 				}
 
-				if (diffAll < periodUs) {
-					vTaskDelay((periodUs - diffAll) / 1000);
-				}
+				dispatchEventsUntil(beforeAll + periodUs);
 				beforeAll = esp_timer_get_time();	 // This is the clean cut where the old interval ends
 
 				dumpStackHighWaterMarkIfIncreased();
@@ -5,9 +5,38 @@
 
 namespace crt
 {
+	class Task;
+	class Waitable;
+	class Flag;
+
 	class IHandler
 	{
 	public:
-		virtual void addHandlerListener(IHandlerListener* pHandlerListener) = 0;
+		// All functions below return false if the request could not be queued: if more than
+		// MAXLISTENERCOUNT listeners would be added, or more than MAXLISTENERCOUNT removals are pending.
+
+		// The update() function of the listener is called periodically.
+		virtual bool addHandlerListener(IHandlerListener* pHandlerListener) = 0;
+
+		// The update() function of the listener is only called when the waitable has fired.
+		// The waitable should be owned by the task of the handler (see getTask()).
+		virtual bool addHandlerListener(IHandlerListener* pHandlerListener, Waitable& waitable) = 0;
+
+		// The update() function of the listener is called periodically, ordered by deadline (in us, 
+		// relative to the start of the period, 0 : none) and priority (higher goes first). 
+		// Under overload, listeners with a low priority can be skipped (see Handler).
+		virtual bool addHandlerListener(IHandlerListener* pHandlerListener, uint8_t priority, uint32_t deadlineUs) = 0;
+
+		// Listeners can be added and removed at any time, from any task.
+		// The removal is carried out later, by the handler task. So don't destroy the listener
+		// right after calling this: use the overload below and wait for the flag instead.
+		virtual bool removeHandlerListener(IHandlerListener* pHandlerListener) = 0;
+
+		// Sets flagRemoved (owned by the calling task) once the handler won't call the listener anymore.
+		// From then on, the listener can be destroyed safely.
+		virtual bool removeHandlerListener(IHandlerListener* pHandlerListener, Flag& flagRemoved) = 0;
+
+		// To construct the Flags, Queues and Timers of event driven listeners with.
+		virtual Task* getTask() = 0;
 	};
 };
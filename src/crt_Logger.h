@@ -35,6 +35,21 @@
 // On a buttonpress, the logs are streamed to the serial monitor and the buffers are cleared.
 // The same can be achieved by calling "dumpNow".
 
+// Calls via ILogger are virtual calls, which can't be inlined. For time critical code, the 
+// logger can be used via its concrete type instead. Then, a log takes just a few stores.
+// (and nothing at all if CRT_DEBUG_LOGGING is not defined). For that end, create the logger 
+// as a DefaultLogger, of which the LOGSIZE is configured in crt_Config.h:
+//
+// DefaultLogger theLogger("Logger", 2 /*priority*/, ARDUINO_RUNNING_CORE, pinButtonDump);
+// ILogger& logger = theLogger;	// Optional: for the code that doesn't need the speed.
+//
+// Where you need the speed, add next lines:
+// #include "crt_Logger.h"
+// extern crt::DefaultLogger theLogger;
+// theLogger.logInt32(playerID);
+//
+// (see the Benchmarks example for the speed of both)
+
 namespace crt
 {
     enum class LogType:uint8_t { lt_None, lt_Text, lt_Int32, lt_Uint32, lt_Float };
@@ -277,4 +292,7 @@ namespace crt
 			}
 		}
 	}; // end class Logger
+
+	// The logger type that can be used without virtual calls (see above).
+	typedef Logger<DEFAULTLOGGER_LOGSIZE> DefaultLogger;
 }; // end namespace CleanRTOS
@@ -0,0 +1,86 @@
+// by Marius Versteegen, 2023
+
+// A Mailbox is a waitable that holds only the latest value written into it, like a "latest setpoint".
+// It combines a Pool and a Flag into a single object: writing a new value overwrites the
+// previous one (even if that was not read yet), and wakes the task that owns the mailbox.
+// (see the Mailbox example in the examples folder)
+//
+//   Mailbox<Setpoint> mailboxSetpoint;         // Member of the owning task,
+//   mailboxSetpoint(this)                      // initialised in its constructor.
+//
+//   wait(mailboxSetpoint);                     // Within the main of the owning task.
+//   mailboxSetpoint.read(setpoint);
+//
+//   mailboxSetpoint.write(setpoint);           // From any task.
+//
+// The eventbit of a mailbox stays set while it holds a value that was not read yet.
+// Only a write into an empty mailbox touches the event group. Overwriting a value that was
+// not read yet takes only the lock.
+//
+// Like with a Pool, the MUTEX can optionally be replaced by an AdaptiveMutex
+// (for instance for a small T that is written often by a task on the other core).
+
+#pragma once
+#include "internals/crt_FreeRTOS.h"
+#include "internals/crt_SimpleMutex.h"
+#include "internals/crt_AdaptiveMutex.h"
+#include "crt_Waitable.h"
+#include "crt_Task.h"
+
+namespace crt
+{
+	template <class T, class MUTEX = SimpleMutex> class Mailbox : public Waitable
+	{
+	private:
+		Task* pTask;
+		T data;
+		bool bFull;					// True while data holds a value that was not read yet.
+		uint32_t nofOverwrites;		// The number of values that were overwritten before they were read.
+		MUTEX mutex;				// No deadlock risk: no other mutexes are locked while it is held.
+
+	public:
+		Mailbox(Task* pTask) : Waitable(WaitableType::wt_Queue), pTask(pTask), bFull(false), nofOverwrites(0)
+		{
+			Waitable::init(pTask->queryBitNumber(this));
+		}
+
+		void write(const T& item)
+		{
+			mutex.lock();
+			data = item;
+			if (bFull)
+			{
+				nofOverwrites++;
+			}
+			else
+			{
+				// The mailbox becomes full. (As reading happens while holding the
+				// same mutex, that cannot race with the clearing of the bit).
+				bFull = true;
+				pTask->setEventBits(Waitable::getBitMask());
+			}
+			mutex.unlock();
+		}
+
+		// Returns false if there was no new value since the previous read.
+		bool read(T& item)
+		{
+			mutex.lock();
+			if (!bFull)
+			{
+				mutex.unlock();
+				return false;
+			}
+			item = data;
+			bFull = false;
+			pTask->clearEventBits(Waitable::getBitMask());
+			mutex.unlock();
+			return true;
+		}
+
+		uint32_t getNofOverwrites()
+		{
+			return nofOverwrites;
+		}
+	};
+};
@@ -1,5 +1,9 @@
 #pragma once
 #include "internals/crt_FreeRTOS.h"
+#include "internals/crt_AdaptiveMutex.h"
+#ifdef CRT_MUTEX_PROFILING
+#include "internals/crt_MutexProfiler.h"
+#endif
 
 namespace crt
 {
@@ -19,47 +23,224 @@ namespace crt
 
 	// Each Task has its own mutex stack. That makes sure that within the Task,
 	// mutexes are always locked in the order of their mutex priority.
+	// That check happens at runtime, if CRT_MUTEX_ORDER_CHECKING is defined (see crt_Config.h).
+	// For a release build, it can be undefined to save the bookkeeping per lock.
+	//
+	// Where the mutex ids are known at compile time, it is better to use an OrderedMutex
+	// (see below). Then, the order can be checked at compile time already.
+	//
+	// By default, a blocked task lends its priority to the task that holds the mutex 
+	// (priority inheritance). Alternatively, a ceiling priority can be specified: the highest
+	// priority of all tasks that lock the mutex. A task that locks the mutex is then raised to 
+	// the ceiling right away, instead of only once another task blocks on it. On a single core,
+	// the other users of the mutex then don't even get to run (and block) while it is held.
+	// That saves the context switches of blocking, and when a task locks several ceiling mutexes,
+	// its blocking time stays bounded by a single critical section (no chained blocking).
+	// (see the PriorityCeiling example in the examples folder)
+	// Note: the priority to return to is read when locking. So don't lock a ceiling mutex while 
+	// the task might have inherited a higher priority via another mutex, that has no ceiling.
+	//
+	// If CRT_MUTEX_PROFILING is defined (see crt_Config.h), each Mutex keeps contention statistics.
+	// Those can be retrieved via the MutexProfiler (see below), to find out which mutexes are hot:
+	// those are the first candidates to be replaced by a "resource keeper".
 	
 	class Mutex
 	{
 	public:
 		uint32_t mutexID;
-		SemaphoreHandle_t freeRtosMutex;
-		BaseType_t rc;
+		UBaseType_t ceilingPriority;	// 0 : no priority ceiling (just priority inheritance).
+		UBaseType_t holderBasePriority;	// The priority of the holder before it was raised to the ceiling.
+		AdaptiveMutex adaptiveMutex;	// Spins briefly if the holder runs on the other core, blocks otherwise.
+#ifdef CRT_MUTEX_PROFILING
+		MutexStatsRecorder statsRecorder;
+#endif
 		
 	public:
 		// MutexSections with lower mutexID can wrap MutexSections with higher mutexID.
 		// but not the other way around (to prevent deadlocks).
-		Mutex(uint32_t mutexID) :
-			mutexID(mutexID), freeRtosMutex(xSemaphoreCreateMutex())
-			//mutexID(mutexID), freeRtosMutex(xSemaphoreCreateBinary())
+		// For ceilingPriority, see the explanation above.
+		Mutex(uint32_t mutexID, UBaseType_t ceilingPriority = 0) :
+			mutexID(mutexID), ceilingPriority(ceilingPriority), holderBasePriority(0)
+#ifdef CRT_MUTEX_PROFILING
+			, statsRecorder(mutexID, adaptiveMutex)
+#endif
 		{
 			assert(mutexID != 0);	// MutexID should not be 0. Zero is reserved (to indicate absence of mutexID)
-			//xSemaphoreGive(freeRtosMutex);	// In case of a binary semaphore: that one should be given before it can be taken.
 		}
 		
 		void lock(Task* pTask)
 		{
-			while (true)
+			bool bLocked = lockTicks(pTask, portMAX_DELAY);
+			assert(bLocked);
+			(void)bLocked;	// Only used by the assert.
+		}
+
+		// Returns false if the mutex could not be locked within timeoutMs.
+		// In that case, it should not be unlocked either.
+		bool lock(Task* pTask, uint32_t timeoutMs)
+		{
+			return lockTicks(pTask, Task::msToTicks(timeoutMs));
+		}
+		
+		void unlock(Task* pTask)
+		{
+#ifdef CRT_MUTEX_ORDER_CHECKING
+			pTask->mutexIdStack.pop();
+#endif
+#ifdef CRT_MUTEX_PROFILING
+			statsRecorder.recordUnlocking();
+#endif
+			UBaseType_t basePriority = holderBasePriority;
+			adaptiveMutex.unlock();
+			if (ceilingPriority > basePriority)
 			{
-				assert(mutexID > pTask->mutexIdStack.top()); // Error : Potential Deadlock : Within each thread, never try to lock a mutex with lower mutex priority than a mutex that is locked(before it).
+				vTaskPrioritySet(NULL, basePriority);
+			}
+		}
+
+	private:
+		bool lockTicks(Task* pTask, TickType_t ticksToWait)
+		{
+#ifdef CRT_MUTEX_ORDER_CHECKING
+			assert(mutexID > pTask->mutexIdStack.top()); // Error : Potential Deadlock : Within each thread, never try to lock a mutex with lower mutex priority than a mutex that is locked(before it).
+#endif
+			// Immediate priority ceiling: raise before locking, so that no other user of the 
+			// mutex can preempt this task while it holds the mutex.
+			UBaseType_t basePriority = uxTaskPriorityGet(NULL);
+			if (ceilingPriority > basePriority)
+			{
+				vTaskPrioritySet(NULL, ceilingPriority);
+			}
 
-				// max tickDelay is the constant portMAX_DELAY
-				rc = xSemaphoreTake(freeRtosMutex, 0.0001 /* tickDelay */);
-				if (rc == pdPASS)
+#ifdef CRT_MUTEX_PROFILING
+			int64_t waitStartUs = esp_timer_get_time();
+			bool bContended = !adaptiveMutex.tryLock();
+			bool bLocked = !bContended || adaptiveMutex.lock(ticksToWait);
+			if (bLocked)
+			{
+				statsRecorder.recordLocked(waitStartUs, bContended);
+			}
+#else
+			bool bLocked = adaptiveMutex.lock(ticksToWait);
+#endif
+			if (!bLocked)
+			{
+				if (ceilingPriority > basePriority)
 				{
-					assert(pTask->mutexIdStack.push(mutexID));// Assert would mean that either the amount of nested concurrently locked mutexes for this task exceeds the constant MAX_MUTEXNESTING, or the lock and unlock of the mutex are not performed in the same task.
-					break;
+					vTaskPrioritySet(NULL, basePriority);
 				}
-				taskYIELD(); // Feed the wdt.
+				return false;
 			}
+			holderBasePriority = basePriority;	// Protected by the mutex itself.
+#ifdef CRT_MUTEX_ORDER_CHECKING
+			bool bPushed = pTask->mutexIdStack.push(mutexID);
+			assert(bPushed);	// Assert would mean that either the amount of nested concurrently locked mutexes for this task exceeds the constant MAX_MUTEXNESTING, or the lock and unlock of the mutex are not performed in the same task.
+			(void)bPushed;	// Only used by the assert.
+#endif
+			return true;
 		}
-		
-		void unlock(Task* pTask)
+	};
+
+#ifdef CRT_MUTEX_PROFILING
+	// The MutexProfiler gives access to the statistics of all Mutexes, by mutexID.
+	// It can be used from any task, at any time:
+	//
+	//   MutexStats stats;
+	//   if (MutexProfiler::getStats(MutexID_Display, stats)) { .. stats.nofContendedAcquisitions .. }
+	//   MutexProfiler::dump();     // Logs the statistics of all mutexes.
+	class MutexProfiler
+	{
+	public:
+		static uint32_t getNofMutexes()
 		{
-			pTask->mutexIdStack.pop();
-			rc = xSemaphoreGive(freeRtosMutex);
-			assert(rc == pdPASS);
+			return MutexStatsRecorder::getNofRecorders();
+		}
+
+		// Returns false if index is out of range.
+		static bool getStatsByIndex(uint32_t index, MutexStats& stats)
+		{
+			MutexStatsRecorder* pRecorder = (index < getNofMutexes()) ? MutexStatsRecorder::getRecorders()[index] : nullptr;
+			if (pRecorder == nullptr)
+			{
+				return false;	// (also if the Mutex is being constructed right now)
+			}
+			pRecorder->copyStats(stats);
+			return true;
+		}
+
+		// Returns false if there is no Mutex with the given mutexID.
+		static bool getStats(uint32_t mutexID, MutexStats& stats)
+		{
+			MutexStatsRecorder* pRecorder = findRecorder(mutexID);
+			if (pRecorder == nullptr)
+			{
+				return false;
+			}
+			pRecorder->copyStats(stats);
+			return true;
+		}
+
+		// Resets the statistics of all mutexes. 
+		// Handy to measure the contention during a specific period.
+		static void resetAll()
+		{
+			for (uint32_t i = 0; i < getNofMutexes(); i++)
+			{
+				MutexStatsRecorder* pRecorder = MutexStatsRecorder::getRecorders()[i];
+				if (pRecorder != nullptr)
+				{
+					pRecorder->reset();
+				}
+			}
+		}
+
+		static void dump()
+		{
+			for (uint32_t i = 0; i < getNofMutexes(); i++)
+			{
+				MutexStats stats;
+				if (!getStatsByIndex(i, stats))
+				{
+					continue;
+				}
+				ESP_LOGI("MutexProfiler", "mutexID %u: %u locks, %u contended, wait total %llu us max %u us, hold max %u us",
+					unsigned(stats.mutexID), unsigned(stats.nofAcquisitions), unsigned(stats.nofContendedAcquisitions),
+					(unsigned long long)stats.totalWaitUs, unsigned(stats.maxWaitUs), unsigned(stats.maxHoldUs));
+			}
+		}
+
+	private:
+		static MutexStatsRecorder* findRecorder(uint32_t mutexID)
+		{
+			for (uint32_t i = 0; i < getNofMutexes(); i++)
+			{
+				MutexStatsRecorder* pRecorder = MutexStatsRecorder::getRecorders()[i];
+				if ((pRecorder != nullptr) && (pRecorder->getMutexID() == mutexID))
+				{
+					return pRecorder;
+				}
+			}
+			return nullptr;
+		}
+	};
+#endif
+
+	// An OrderedMutex is a Mutex of which the mutexID is part of its type.
+	// When it is locked via OrderedMutexSections, the locking order is checked at compile time:
+	// a nested OrderedMutexSection is constructed from the OrderedMutexSection that encloses it,
+	// and it won't compile if its mutexID is not higher than that of the enclosing one.
+	// (see crt_MutexSection.h)
+	//
+	// As it is a Mutex as well, it can still be used with a normal MutexSection, 
+	// for instance where the mutex is passed on as a Mutex&.
+	template<uint32_t ID> class OrderedMutex : public Mutex
+	{
+	public:
+		static const uint32_t orderedMutexID = ID;
+
+		OrderedMutex(UBaseType_t ceilingPriority = 0) : Mutex(ID, ceilingPriority)
+		{
+			static_assert(ID != 0, "MutexID should not be 0. Zero is reserved (to indicate absence of mutexID)");
 		}
 	};
 };
@@ -20,14 +20,79 @@ namespace crt
 	private:
 		Task* pTask;
 		Mutex& mutex;
+		bool bLocked;
 	public:
-		MutexSection(Task* pTask, Mutex& mutex) : pTask(pTask), mutex(mutex)
+		MutexSection(Task* pTask, Mutex& mutex) : pTask(pTask), mutex(mutex), bLocked(true)
 		{
 			mutex.lock(pTask);
 		}
+
+		// Gives up if the mutex could not be locked within timeoutMs. Check isLocked() to find out:
+		//
+		//   MutexSection ms(this, mutexDisplay, 5);
+		//   if (ms.isLocked()) { .. } else { .. }
+		MutexSection(Task* pTask, Mutex& mutex, uint32_t timeoutMs) : pTask(pTask), mutex(mutex)
+		{
+			bLocked = mutex.lock(pTask, timeoutMs);
+		}
+
 		~MutexSection()
+		{
+			if (bLocked)
+			{
+				mutex.unlock(pTask);
+			}
+		}
+
+		bool isLocked()
+		{
+			return bLocked;
+		}
+	};
+
+	// An OrderedMutexSection locks an OrderedMutex. The outermost one is constructed from the Task,
+	// nested ones from the OrderedMutexSection that encloses them. That way, the compiler can check
+	// that the mutexes are locked in the order of their ids:
+	//
+	//   OrderedMutexSection<1> msA(this, mutexA);	// mutexA is an OrderedMutex<1>
+	//   OrderedMutexSection<2> msB(msA, mutexB);		// ok
+	//   OrderedMutexSection<1> msX(msB, mutexA);		// compile error: potential deadlock.
+	//
+	// Functions that need to be called with a mutex locked can demand that by taking the
+	// OrderedMutexSection as parameter.
+	template<uint32_t ID> class OrderedMutexSection
+	{
+	private:
+		Task* pTask;
+		OrderedMutex<ID>& mutex;
+
+	public:
+		static const uint32_t mutexID = ID;
+
+		OrderedMutexSection(Task* pTask, OrderedMutex<ID>& mutex) : pTask(pTask), mutex(mutex)
+		{
+			mutex.lock(pTask);	// If CRT_MUTEX_ORDER_CHECKING is defined, this checks against the non-ordered mutexes at runtime too.
+		}
+
+		template<uint32_t OUTERID> OrderedMutexSection(const OrderedMutexSection<OUTERID>& outerSection, OrderedMutex<ID>& mutex) :
+			pTask(outerSection.getTask()), mutex(mutex)
+		{
+			static_assert(ID > OUTERID, "Potential deadlock: within each thread, never lock a mutex with a lower id than a mutex that is locked before it.");
+			mutex.lock(pTask);
+		}
+
+		// A copy would unlock the mutex a second time.
+		OrderedMutexSection(const OrderedMutexSection&) = delete;
+		OrderedMutexSection& operator=(const OrderedMutexSection&) = delete;
+
+		~OrderedMutexSection()
 		{
 			mutex.unlock(pTask);
 		}
+
+		Task* getTask() const
+		{
+			return pTask;
+		}
 	};
 };
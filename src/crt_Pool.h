@@ -2,39 +2,77 @@
 
 // Pools can be used to protect access to shared data without 
 // explicitly worrying about mutexes. The class of the shared data should provide a copy constructor.
-// Internally, a SimpleMutex is used to avoid concurrent access to the encapsulated data.
+// Internally, a SimpleMutex (by default) is used to avoid concurrent access to the encapsulated data.
 // (see the Pool example in the examples folder)
 
 #pragma once
 #include "internals/crt_FreeRTOS.h"
 #include "internals/crt_SimpleMutex.h"
+#include "internals/crt_AdaptiveMutex.h"
 #include "crt_Mutex.h"
 #include "crt_MutexSection.h"
 
 namespace crt
 {
 	// This class allows automatic Mutex release using the RAI-pattern.
-	template <class T> class Pool
+	// The MUTEX can optionally be replaced by an AdaptiveMutex (for instance for a small T that is 
+	// accessed often by tasks on both cores), or by anything else that offers lock() and unlock().
+	template <class T, class MUTEX = SimpleMutex> class Pool
 	{
 	private:
         T data;
-		SimpleMutex simpleMutex;	// Unlike with Mutex, SimpleMutex does not offer deadlock protection,
+		MUTEX mutex;				// Unlike Mutex, SimpleMutex and AdaptiveMutex do not offer deadlock protection,
 	public:                         // but that is no problem because the Pool inheritely poses no deadlock thread. (no case of multiple mutexes that can have different lock orders).
 		Pool()
 		{}
 		
 		void write (T item) 
 		{
-			simpleMutex.lock();
+			mutex.lock();
 			data = item;
-			simpleMutex.unlock();
+			mutex.unlock();
 		}
       
 		void read (T& item)
 		{
-			simpleMutex.lock();
+			mutex.lock();
 			item = data;
-			simpleMutex.unlock();
+			mutex.unlock();
+		}
+
+		// Calls visitor(const T&) while the data is protected, which avoids copying it.
+		// Keep such visitors short: other tasks have to wait for them.
+		template <class VISITOR> void read (VISITOR&& visitor)
+		{
+			mutex.lock();
+			visitor((const T&)data);
+			mutex.unlock();
+		}
+
+		// Calls modifier(T&) on the data itself, within a single lock.
+		// Use this instead of a read followed by a write: that would cost two copies
+		// and two locks, and another task could write in between (and that update would get lost).
+		//
+		//   pool.modify([](TwoNumbers& twoNumbers) { twoNumbers.number1 += 2; twoNumbers.number2 += 2; });
+		template <class MODIFIER> void modify (MODIFIER&& modifier)
+		{
+			mutex.lock();
+			modifier(data);
+			mutex.unlock();
+		}
+
+		// Writes item only if the data still equals expected (T should provide operator==).
+		// Returns false if it did not, for instance because another task wrote in between.
+		bool compareAndWrite (const T& expected, const T& item)
+		{
+			mutex.lock();
+			bool bEqual = (data == expected);
+			if (bEqual)
+			{
+				data = item;
+			}
+			mutex.unlock();
+			return bEqual;
 		}
 	};
 };
@@ -0,0 +1,125 @@
+// by Marius Versteegen, 2023
+
+// A PriorityQueue is a waitable, like a Queue. Each message is written with a level of urgency.
+// The message with the highest level is read first. Messages with the same level are read
+// in the order in which they were written.
+// That way, an urgent command doesn't have to wait behind a backlog of telemetry.
+//
+//   PriorityQueue<Message, 10, 3> queueMessages;     // Member of the owning task (10 messages per level, levels 0..2),
+//   queueMessages(this)                              // initialised in its constructor.
+//
+//   wait(queueMessages);                             // Within the main of the owning task.
+//   queueMessages.read(message);
+//
+//   queueMessages.write(message, 2 /*level*/);       // From any task.
+//
+// Every level has a ring buffer of its own. A bitmap of the non-empty levels makes finding
+// the highest non-empty level a single instruction (count leading zeros).
+// Like the eventbit of a queue, the eventbit of a PriorityQueue stays set while it is not empty.
+// (For a single level of urgent messages, Queue::writeToFront can be used as well)
+
+#pragma once
+#include "internals/crt_FreeRTOS.h"
+#include "internals/crt_SimpleMutex.h"
+#include "crt_Waitable.h"
+#include "crt_Task.h"
+
+namespace crt
+{
+	template<typename TYPE, uint32_t COUNT, uint32_t LEVELS> class PriorityQueue : public Waitable
+	{
+		static_assert((LEVELS >= 1) && (LEVELS <= 32), "The levels of a PriorityQueue should fit in a 32 bit bitmap");
+
+	private:
+		Task* pTask;
+		TYPE arItems[LEVELS][COUNT];
+		uint32_t arReadIndex[LEVELS];
+		uint32_t arNofItems[LEVELS];
+		uint32_t nonEmptyLevels;	// Bit n is set if level n contains messages.
+		uint32_t nofDroppedWrites;
+		SimpleMutex simpleMutex;	// No deadlock risk: no other mutexes are locked while it is held.
+
+	public:
+		PriorityQueue(Task* pTask) : Waitable(WaitableType::wt_Queue), pTask(pTask),
+			arReadIndex(), arNofItems(), nonEmptyLevels(0), nofDroppedWrites(0)
+		{
+			Waitable::init(pTask->queryBitNumber(this));
+		}
+
+		// Returns false if the given level was full already.
+		bool write(const TYPE& item, uint32_t level)
+		{
+			assert(level < LEVELS);
+			simpleMutex.lock();
+			if (arNofItems[level] == COUNT)
+			{
+				nofDroppedWrites++;
+				simpleMutex.unlock();
+				return false;
+			}
+			arItems[level][(arReadIndex[level] + arNofItems[level]) % COUNT] = item;
+			arNofItems[level]++;
+			if (nonEmptyLevels == 0)
+			{
+				// The queue becomes non-empty. (As reading happens while holding the
+				// same mutex, that cannot race with the clearing of the bit).
+				pTask->setEventBits(Waitable::getBitMask());
+			}
+			nonEmptyLevels |= (1u << level);
+			simpleMutex.unlock();
+			return true;
+		}
+
+		// Reads the oldest message of the highest non-empty level.
+		// Returns false if there was nothing to read.
+		bool read(TYPE& item)
+		{
+			uint32_t level = 0;
+			return read(item, level);
+		}
+
+		// Same as above, and returns the level of the message as well.
+		bool read(TYPE& item, uint32_t& level)
+		{
+			simpleMutex.lock();
+			if (nonEmptyLevels == 0)
+			{
+				simpleMutex.unlock();
+				return false;
+			}
+			level = 31 - __builtin_clz(nonEmptyLevels);
+			item = arItems[level][arReadIndex[level]];
+			arReadIndex[level] = (arReadIndex[level] + 1) % COUNT;
+			arNofItems[level]--;
+			if (arNofItems[level] == 0)
+			{
+				nonEmptyLevels &= ~(1u << level);
+				if (nonEmptyLevels == 0)
+				{
+					// The queue becomes empty.
+					pTask->clearEventBits(Waitable::getBitMask());
+				}
+			}
+			simpleMutex.unlock();
+			return true;
+		}
+
+		uint32_t getNofMessagesWaiting()
+		{
+			simpleMutex.lock();
+			uint32_t nofMessages = 0;
+			for (uint32_t level = 0; level < LEVELS; level++)
+			{
+				nofMessages += arNofItems[level];
+			}
+			simpleMutex.unlock();
+			return nofMessages;
+		}
+
+		// The number of writes that failed because their level was full.
+		uint32_t getNofDroppedWrites()
+		{
+			return nofDroppedWrites;
+		}
+	};
+};
@@ -5,60 +5,93 @@
 // (see the Queue example in the examples folder)
 
 #pragma once
+#include <atomic>
+#include <type_traits>
 #include "internals/crt_FreeRTOS.h"
 #include "crt_Waitable.h"
 #include "crt_Task.h"
+#include "crt_QueueStats.h"
 #include "crt_ILogger.h"
 namespace crt
 {
     //extern ILogger& logger;
 
-	template<typename TYPE, uint32_t COUNT> class Queue : public Waitable
+	// The eventbit of a queue is set while the queue is not empty.
+	// To keep the amount of event group operations low, the queue keeps its own (atomic) count
+	// of messages. The eventbit is only set when the queue becomes non-empty, and only cleared
+	// when it becomes empty. While a busy queue keeps containing messages, reading and
+	// writing do not touch the event group at all.
+	// The count is incremented after the message is in, and decremented after it is out.
+	// Thus, a reader that wakes up on the bit always finds a message.
+	// Writers and readers that race each other may update the bit in the wrong order. That is 
+	// why the bit is made to follow the count, which is checked again after each update.
+	// To drain a queue without blocking (for instance to handle all requests at once), use tryRead().
+	// (see the Benchmarks example for a measurement of the message rate)
+	//
+	// To make overload visible, statistics can be enabled per queue (see crt_QueueStats.h), like
+	// its high-water mark (the maximum number of messages it contained at once), the number of
+	// writes that failed because it was full, and the latency of the messages.
+	// (see the TokenBucket example for the statistics, and for a way to pace a producer instead)
+
+	template<typename TYPE, uint32_t COUNT, class STATSRECORDER = NoQueueStatsRecorder> class Queue : public Waitable
 	{
 	private:
+        struct TimestampedItem
+        {
+            TYPE item;
+            uint32_t writeTimeUs;   // The lower 32 bits of esp_timer_get_time(): differences remain correct.
+        };
+        // Only if the statistics are enabled, the items are stored with a timestamp.
+        typedef typename ::std::conditional<STATSRECORDER::bTimestamped, TimestampedItem, TYPE>::type Entry;
+        typedef ::std::integral_constant<bool, STATSRECORDER::bTimestamped> Timestamped;
+
 		QueueHandle_t qh;
         Task* pTask;
         TickType_t writeDelay;
-		TYPE dummy;
+		Entry dummy;
+        ::std::atomic<uint32_t> nofMessages;  // Incremented after a message is in, decremented after it is out.
+        STATSRECORDER statsRecorder;
 
 	public:
 		Queue(Task* pTask,bool bWriteWaitIfQueueFull=false):Waitable(WaitableType::wt_Queue),pTask(pTask),
-            writeDelay(bWriteWaitIfQueueFull ? portMAX_DELAY : 0)
+            writeDelay(bWriteWaitIfQueueFull ? portMAX_DELAY : 0), nofMessages(0)
 		{
             Waitable::init(pTask->queryBitNumber(this));
-			qh = xQueueCreate(COUNT, sizeof(TYPE));
+			qh = xQueueCreate(COUNT, sizeof(Entry));
 		}
 		
 		///*override*/ bool operator==(const Waitable& other) const { return this == &other; };
 
 		void read(TYPE& returnVariable) 
 		{
-			BaseType_t rc = xQueueReceive(qh, &returnVariable, portMAX_DELAY);
-            if (uxQueueMessagesWaiting(qh) > 0)
-            {
-                // The queue is not empty yet,
-                // Make sure that the corresponding eventbit gets set again,
-                // Such that a wait for the queue will fire.
-                pTask->setEventBits(Waitable::getBitMask());
-            }
-            else
-            {
-                // Just in case this queue.read is called directly, without preceding
-                // waitAny or waitAll (which would have cleared the corresponding bit).
-            }
+			BaseType_t rc = receive(returnVariable, portMAX_DELAY, Timestamped());
 			assert(rc == pdPASS);
+            onMessageOut();
+		}
+
+		// Returns false if the queue is empty, instead of waiting for a message.
+		bool tryRead(TYPE& returnVariable)
+		{
+			if (receive(returnVariable, 0, Timestamped()) != pdPASS)
+			{
+				return false;
+			}
+            onMessageOut();
+			return true;
 		}
 
 		bool write(TYPE& variableToCopy)
 		{
-			BaseType_t rc = xQueueSend(qh, &variableToCopy, writeDelay);
-            if (rc != pdPASS)
-            {
-                // The queue got full. Note: that cannot happen if bWriteWaitIfQueueFull==true.
-                return false;
-            }
-            pTask->setEventBits(Waitable::getBitMask());
-            return true;
+			return writeMessage(variableToCopy, false);
+		}
+
+		// Puts the message in front of the messages that are waiting already,
+		// such that it is read next. Meant for urgent messages, like commands,
+		// that should not wait behind a backlog of less urgent ones.
+		// (If there are multiple levels of urgency, consider a PriorityQueue)
+		bool writeToFront(TYPE& variableToCopy)
+		{
+			return writeMessage(variableToCopy, true);
 		}
 
 		int getNofMessagesWaiting()
@@ -66,15 +99,129 @@ namespace crt
 			return uxQueueMessagesWaiting(qh);
 		}
 
+		void resetStats()
+		{
+			statsRecorder.reset();
+		}
+
+		// Can be called from any task. Without a QueueStatsRecorder, all stats are 0.
+		// If maxFill reaches COUNT, the queue is probably too small, or the consumer too slow.
+		void copyStats(QueueStats& stats)
+		{
+			statsRecorder.copyStats(stats);
+			if (stats.nofReads == 0)
+			{
+				stats.minLatencyUs = 0;
+			}
+		}
+
+		void logStats(const char* queueName)
+		{
+			QueueStats stats;
+			copyStats(stats);
+			ESP_LOGI("Queue", "%s: writes %u, reads %u, failed writes %u, max fill %u of %u, latency min/avg/max %u/%u/%u us",
+				queueName, unsigned(stats.nofWrites), unsigned(stats.nofReads), unsigned(stats.nofFailedWrites),
+				unsigned(stats.maxFill), unsigned(COUNT),
+				unsigned(stats.minLatencyUs), unsigned(stats.getAvgLatencyUs()), unsigned(stats.maxLatencyUs));
+		}
+
 		void clear()
 		{
-			while (uxQueueMessagesWaiting(qh) > 0)
+			while (xQueueReceive(qh, &dummy, 0) == pdPASS)
 			{
-				xQueueReceive(qh, &dummy, portMAX_DELAY);
+				onMessageOut();
 			}
-			
-			pTask->clearEventBits(Waitable::getBitMask());
 		}
+
+	private:
+        bool writeMessage(TYPE& variableToCopy, bool bToFront)
+        {
+            BaseType_t rc = send(variableToCopy, bToFront, Timestamped());
+            if (rc != pdPASS)
+            {
+                // The queue got full. Note: that cannot happen if bWriteWaitIfQueueFull==true.
+                statsRecorder.recordFailedWrite();
+                return false;
+            }
+            int32_t oldNofMessages = (int32_t)nofMessages.fetch_add(1);
+            if (oldNofMessages == 0)
+            {
+                // The queue just became non-empty.
+                updateEventBit();
+            }
+            // (The message may have been read already, before it was counted)
+            statsRecorder.recordWrite((oldNofMessages >= 0) ? (uint32_t)(oldNofMessages + 1) : 1);
+            return true;
+        }
+
+        inline BaseType_t send(const void* pEntry, bool bToFront)
+        {
+            return bToFront ? xQueueSendToFront(qh, pEntry, writeDelay) : xQueueSendToBack(qh, pEntry, writeDelay);
+        }
+
+        inline BaseType_t send(TYPE& variableToCopy, bool bToFront, ::std::false_type)
+        {
+            return send(&variableToCopy, bToFront);
+        }
+
+        inline BaseType_t send(TYPE& variableToCopy, bool bToFront, ::std::true_type)
+        {
+            TimestampedItem entry;
+            entry.item = variableToCopy;
+            entry.writeTimeUs = (uint32_t)esp_timer_get_time();
+            return send(&entry, bToFront);
+        }
+
+        inline BaseType_t receive(TYPE& returnVariable, TickType_t ticksToWait, ::std::false_type)
+        {
+            return xQueueReceive(qh, &returnVariable, ticksToWait);
+        }
+
+        inline BaseType_t receive(TYPE& returnVariable, TickType_t ticksToWait, ::std::true_type)
+        {
+            TimestampedItem entry;
+            BaseType_t rc = xQueueReceive(qh, &entry, ticksToWait);
+            if (rc == pdPASS)
+            {
+                returnVariable = entry.item;
+                statsRecorder.recordRead((uint32_t)esp_timer_get_time() - entry.writeTimeUs);
+            }
+            return rc;
+        }
+
+        inline void onMessageOut()
+        {
+            if (nofMessages.fetch_sub(1) == 1)
+            {
+                // The queue just became empty.
+                updateEventBit();
+            }
+        }
+
+        // Sets the bit if the queue contains messages, clears it otherwise.
+        // A writer or reader that sneaked in meanwhile may have updated the bit as well, 
+        // in the opposite direction, just before this update undid that. Thus, check again.
+        // (The count can be -1 for a moment, if a message was read before its writer counted it)
+        inline void updateEventBit()
+        {
+            bool bNonEmpty = ((int32_t)nofMessages.load() > 0);
+            while (true)
+            {
+                if (bNonEmpty)
+                {
+                    pTask->setEventBits(Waitable::getBitMask());
+                }
+                else
+                {
+                    pTask->clearEventBits(Waitable::getBitMask());
+                }
+                bool bStillNonEmpty = ((int32_t)nofMessages.load() > 0);
+                if (bStillNonEmpty == bNonEmpty)
+                {
+                    return;
+                }
+                bNonEmpty = bStillNonEmpty;
+            }
+        }
 	};
 };
-
@@ -0,0 +1,109 @@
+// by Marius Versteegen, 2023
+
+#pragma once
+#include "internals/crt_FreeRTOS.h"
+#include "internals/crt_TaskCriticalSection.h"
+
+// The statistics of a Queue help to size its COUNT, and to spot slow consumers and overload.
+// They are enabled per queue, by passing QueueStatsRecorder as its third template parameter:
+//
+//   Queue<int32_t, 10, QueueStatsRecorder> queueNumbers;
+//
+//   QueueStats stats;
+//   queueNumbers.copyStats(stats);      // From any task.
+//   queueNumbers.logStats("Numbers");
+//
+// By default, a queue uses the NoQueueStatsRecorder, which does nothing. Then the queue
+// items don't get a timestamp, and no time is spent on recording at all.
+
+namespace crt
+{
+	struct QueueStats
+	{
+		uint32_t nofWrites;
+		uint32_t nofReads;
+		uint32_t nofFailedWrites;	// Writes that failed because the queue was full.
+		uint32_t maxFill;			// The maximum number of messages that the queue contained at once.
+		uint32_t minLatencyUs;		// The time between the write and the read of a message.
+		uint32_t maxLatencyUs;
+		uint64_t totalLatencyUs;
+
+		uint32_t getAvgLatencyUs() const
+		{
+			return (nofReads == 0) ? 0 : (uint32_t)(totalLatencyUs / nofReads);
+		}
+	};
+
+	class NoQueueStatsRecorder
+	{
+	public:
+		static const bool bTimestamped = false;
+
+		inline void recordWrite(uint32_t /*nofMessagesNow*/) {}
+		inline void recordFailedWrite() {}
+		inline void recordRead(uint32_t /*latencyUs*/) {}
+		inline void copyStats(QueueStats& statsCopy) { statsCopy = QueueStats(); }
+		inline void reset() {}
+	};
+
+	// The record functions are called by the queue, from the writing and reading tasks.
+	// A spinlock of its own keeps the statistics consistent.
+	class QueueStatsRecorder
+	{
+	private:
+		QueueStats stats;
+		SpinLock spinLock;
+
+	public:
+		static const bool bTimestamped = true;	// The queue stores a timestamp with each item.
+
+		QueueStatsRecorder()
+		{
+			reset();
+		}
+
+		inline void recordWrite(uint32_t nofMessagesNow)
+		{
+			TaskCriticalSection cs(spinLock);
+			stats.nofWrites++;
+			if (nofMessagesNow > stats.maxFill)
+			{
+				stats.maxFill = nofMessagesNow;
+			}
+		}
+
+		inline void recordFailedWrite()
+		{
+			TaskCriticalSection cs(spinLock);
+			stats.nofFailedWrites++;
+		}
+
+		inline void recordRead(uint32_t latencyUs)
+		{
+			TaskCriticalSection cs(spinLock);
+			stats.nofReads++;
+			stats.totalLatencyUs += latencyUs;
+			if (latencyUs < stats.minLatencyUs)
+			{
+				stats.minLatencyUs = latencyUs;
+			}
+			if (latencyUs > stats.maxLatencyUs)
+			{
+				stats.maxLatencyUs = latencyUs;
+			}
+		}
+
+		void copyStats(QueueStats& statsCopy)
+		{
+			TaskCriticalSection cs(spinLock);
+			statsCopy = stats;
+		}
+
+		void reset()
+		{
+			TaskCriticalSection cs(spinLock);
+			stats = QueueStats();
+			stats.minLatencyUs = 0xFFFFFFFF;
+		}
+	};
+};
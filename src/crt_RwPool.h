@@ -0,0 +1,81 @@
+// by Marius Versteegen, 2023
+
+// An RwPool is like a Pool, but meant for data that is read often, by many tasks, and written
+// rarely (like configuration and calibration tables).
+// Unlike with a Pool, multiple tasks (on both cores) can read the data at the same time.
+// A write waits for the ongoing reads to finish, and new reads wait for the pending write.
+//
+// Apart from copying the data with read(item), it can also be inspected in place, 
+// which avoids copying large data:
+//
+//   float gain = 0;
+//   poolCalibration.read([&](const Calibration& calibration) { gain = calibration.gain[channel]; });
+//
+// Keep such visitors short: writers have to wait for them.
+// (see the Benchmarks example for a comparison of the read throughput with that of a Pool)
+
+#pragma once
+#include "internals/crt_FreeRTOS.h"
+#include "internals/crt_SimpleRwMutex.h"
+
+namespace crt
+{
+	template <class T> class RwPool
+	{
+	private:
+        T data;
+		SimpleRwMutex simpleRwMutex;	// Like the SimpleMutex of the Pool, no deadlock protection is needed.
+
+	public:
+		RwPool()
+		{}
+		
+		void write (T item) 
+		{
+			simpleRwMutex.lockWrite();
+			data = item;
+			simpleRwMutex.unlockWrite();
+		}
+      
+		void read (T& item)
+		{
+			simpleRwMutex.lockRead();
+			item = data;
+			simpleRwMutex.unlockRead();
+		}
+
+		// Calls visitor(const T&) while the data is protected against writes.
+		template <class VISITOR> void read (VISITOR&& visitor)
+		{
+			simpleRwMutex.lockRead();
+			visitor((const T&)data);
+			simpleRwMutex.unlockRead();
+		}
+
+		// Calls modifier(T&) on the data itself, as a single write. So it waits for the ongoing
+		// reads, and no reader sees a half updated table. Unlike a read followed by a write, no
+		// update by another task can get lost in between.
+		//
+		//   poolCalibration.modify([&](Calibration& calibration) { calibration.gain[channel] *= correction; });
+		template <class MODIFIER> void modify (MODIFIER&& modifier)
+		{
+			simpleRwMutex.lockWrite();
+			modifier(data);
+			simpleRwMutex.unlockWrite();
+		}
+
+		// Writes item only if the data still equals expected (T should provide operator==).
+		// Returns false if it did not, for instance because another task wrote in between.
+		bool compareAndWrite (const T& expected, const T& item)
+		{
+			simpleRwMutex.lockWrite();
+			bool bEqual = (data == expected);
+			if (bEqual)
+			{
+				data = item;
+			}
+			simpleRwMutex.unlockWrite();
+			return bEqual;
+		}
+	};
+};
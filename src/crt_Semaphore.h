@@ -0,0 +1,177 @@
+// by Marius Versteegen, 2023
+
+// A Semaphore is a waitable that counts units of a resource, like free DMA buffers or tokens.
+// Other tasks (or interrupt handlers) give units, the task that owns the semaphore takes them.
+// (see the Benchmarks example for a comparison with a Queue that is used for counting)
+//
+//   Semaphore semFreeBuffers;                 // Member of the owning task,
+//   semFreeBuffers(this, 0, nofBuffers)       // initialised in its constructor (count, maxCount).
+//
+//   wait(semFreeBuffers);                     // Within the main of the owning task.
+//   if (semFreeBuffers.take()) { .. }
+//
+//   semFreeBuffers.give();                    // From any task,
+//   semFreeBuffers.giveFromISR();             // or from an interrupt handler.
+//
+// Like the eventbit of a queue, the eventbit of a semaphore stays set while its count > 0.
+// Only the transitions from 0 to 1 and from 1 to 0 touch the event group: giving and taking
+// units while the count stays above zero is just an atomic operation.
+//
+// In rare cases (a give and a take racing each other) the eventbit can be set while the count
+// is already 0 again. take() then returns false, and clears the stale bit (checking the count
+// again afterwards), so just wait again in that case.
+//
+// Note: an interrupt handler can't set the eventbit directly. giveFromISR() lets the FreeRTOS
+// timer task set it a moment later. If the command queue of the timer task is full, the give is
+// undone and giveFromISR() returns false (if the timer task lags behind, increase its priority
+// or queue length in sdkconfig).
+
+#pragma once
+#include <atomic>
+#include "internals/crt_FreeRTOS.h"
+#include "crt_Waitable.h"
+#include "crt_Task.h"
+
+namespace crt
+{
+	class Semaphore : public Waitable
+	{
+	private:
+		Task* pTask;
+		uint32_t maxCount;
+		::std::atomic<uint32_t> count;
+
+	public:
+		Semaphore(Task* pTask, uint32_t initialCount = 0, uint32_t maxCount = 0xFFFFFFFF) :
+			Waitable(WaitableType::wt_Semaphore), pTask(pTask), maxCount(maxCount), count(initialCount)
+		{
+			assert(initialCount <= maxCount);
+			Waitable::init(pTask->queryBitNumber(this));
+			if (initialCount > 0)
+			{
+				pTask->setEventBits(Waitable::getBitMask());
+			}
+		}
+
+		// Returns false if the count was at maxCount already.
+		bool give()
+		{
+			uint32_t oldCount = 0;
+			if (!increment(oldCount))
+			{
+				return false;
+			}
+			if (oldCount == 0)
+			{
+				// The semaphore just became non-empty.
+				pTask->setEventBits(Waitable::getBitMask());
+			}
+			return true;
+		}
+
+		// Same as above, to be called from an interrupt handler.
+		// Also returns false if the eventbit could not be set (see the note above).
+		bool giveFromISR()
+		{
+			uint32_t oldCount = 0;
+			if (!increment(oldCount))
+			{
+				return false;
+			}
+			if ((oldCount == 0) && !pTask->setEventBitsFromISR(Waitable::getBitMask()))
+			{
+				// Nobody would be woken up for this unit: undo the give,
+				// unless the unit was taken meanwhile after all.
+				if (!decrement(oldCount))
+				{
+					return true;
+				}
+				if (count.load() > 0)
+				{
+					// Another giver came in meanwhile. It saw a count above 0, so it relied on 
+					// the bit that this give failed to set. Try once more for its sake.
+					pTask->setEventBitsFromISR(Waitable::getBitMask());
+				}
+				return false;
+			}
+			return true;
+		}
+
+		// Returns false if the count was 0.
+		bool take()
+		{
+			uint32_t oldCount = 0;
+			if (!decrement(oldCount))
+			{
+				// The bit may be stale: set by a giver after the count had dropped to 0 again.
+				// Clear it, or waiting for the semaphore would return right away, again and again.
+				updateEventBit();
+				return false;
+			}
+			if (oldCount == 1)
+			{
+				// The semaphore just became empty.
+				updateEventBit();
+			}
+			return true;
+		}
+
+		uint32_t getCount()
+		{
+			return count.load();
+		}
+
+	private:
+		// Sets the bit if the count is above 0, clears it otherwise.
+		// A giver that sneaked in meanwhile may have set the bit just before this update
+		// cleared it (or the other way around). Thus, check the count again.
+		inline void updateEventBit()
+		{
+			bool bNonEmpty = (count.load() > 0);
+			while (true)
+			{
+				if (bNonEmpty)
+				{
+					pTask->setEventBits(Waitable::getBitMask());
+				}
+				else
+				{
+					pTask->clearEventBits(Waitable::getBitMask());
+				}
+				bool bStillNonEmpty = (count.load() > 0);
+				if (bStillNonEmpty == bNonEmpty)
+				{
+					return;
+				}
+				bNonEmpty = bStillNonEmpty;
+			}
+		}
+
+		inline bool increment(uint32_t& oldCount)
+		{
+			oldCount = count.load();
+			do
+			{
+				if (oldCount >= maxCount)
+				{
+					return false;
+				}
+			} while (!count.compare_exchange_weak(oldCount, oldCount + 1));
+			return true;
+		}
+
+		// Doesn't touch the event group, so giveFromISR() can use it as well.
+		inline bool decrement(uint32_t& oldCount)
+		{
+			oldCount = count.load();
+			do
+			{
+				if (oldCount == 0)
+				{
+					return false;
+				}
+			} while (!count.compare_exchange_weak(oldCount, oldCount - 1));
+			return true;
+		}
+	};
+};
@@ -0,0 +1,206 @@
+// by Marius Versteegen, 2023
+
+// A StateMachineTask runs many small, reactive state machines within a single task.
+// That saves a stack and an event group per state machine, compared to giving each
+// of them a Task of its own.
+//
+// Instead of a main() loop with waitAny and a chain of hasFired checks, a StateMachine binds
+// its waitables to handler member functions, per state:
+//
+//   class TrafficLight : public StateMachine<TrafficLight>
+//   {
+//       enum State { stRed, stGreen };
+//       Timer timer;                                            // Owned by the StateMachineTask.
+//       Flag flagEmergency;
+//   public:
+//       TrafficLight(IStateMachineTask& smTask) : StateMachine(smTask, stRed),
+//           timer(smTask.getTask()), flagEmergency(smTask.getTask())
+//       {
+//           on(stRed,   timer, &TrafficLight::onRedTimeout);
+//           on(stGreen, timer, &TrafficLight::onGreenTimeout);
+//           on(anyState, flagEmergency, &TrafficLight::onEmergency);
+//           timer.start(5000000);
+//       }
+//       void onRedTimeout()   { setState(stGreen); timer.start(3000000); }
+//       ...
+//   };
+//
+// The StateMachineTask only waits for the waitables that are bound in the current states
+// of the machines. A waitable that fires while its machine is in a state that doesn't
+// handle it, stays fired till the machine enters a state that does.
+//
+// Notes:
+//   * Each waitable should be bound by a single machine.
+//   * The waitables of all machines share the 24 event bits of the StateMachineTask.
+//   * A handler should never block, because that would block the other machines as well.
+//   * Like tasks, state machines should be created in main.cpp (or .ino), before the
+//     scheduler starts. They can't be added to a running StateMachineTask.
+
+// (see the StateMachines example in the examples folder)
+
+#pragma once
+#include "internals/crt_FreeRTOS.h"
+#include "crt_Task.h"
+
+namespace crt
+{
+	// The StateMachine as seen by the StateMachineTask.
+	class IStateMachine
+	{
+	public:
+		virtual uint32_t getBitsToWaitFor() = 0;		// The bits of the waitables bound in the current state.
+		virtual void dispatch(uint32_t firedBitMask) = 0;
+	};
+
+	// The StateMachineTask as seen by its StateMachines.
+	class IStateMachineTask
+	{
+	public:
+		virtual void addStateMachine(IStateMachine* pStateMachine) = 0;
+
+		// To construct the Flags, Queues and Timers of the state machines with.
+		virtual Task* getTask() = 0;
+	};
+
+	template<class DERIVED, unsigned int MAXBINDINGS = 8> class StateMachine : public IStateMachine
+	{
+	public:
+		typedef void (DERIVED::*Handler)();
+		static const uint32_t anyState = 0xFFFFFFFF;
+
+	private:
+		struct Binding
+		{
+			uint32_t state;
+			uint32_t bitMask;
+			Handler handler;
+		};
+
+		Binding arBindings[MAXBINDINGS];
+		uint32_t nofBindings;
+		uint32_t state;
+		uint32_t bitsToWaitFor;		// Cache of the bits bound in the current state.
+
+	protected:
+		StateMachine(IStateMachineTask& stateMachineTask, uint32_t initialState) :
+			nofBindings(0), state(initialState), bitsToWaitFor(0)
+		{
+			stateMachineTask.addStateMachine(this);
+		}
+
+		// From now on, handler is called when waitable fires while the machine is in the given state
+		// (or in any state, if anyState is passed).
+		void on(uint32_t state, Waitable& waitable, Handler handler)
+		{
+			assert(nofBindings < MAXBINDINGS);
+			Binding binding = { state, waitable.getBitMask(), handler };
+			arBindings[nofBindings++] = binding;
+			updateBitsToWaitFor();
+		}
+
+		void setState(uint32_t newState)
+		{
+			state = newState;
+			updateBitsToWaitFor();
+		}
+
+	public:
+		uint32_t getState()
+		{
+			return state;
+		}
+
+		/*override keyword not supported in current compiler*/
+		uint32_t getBitsToWaitFor()
+		{
+			return bitsToWaitFor;
+		}
+
+		/*override keyword not supported in current compiler*/
+		void dispatch(uint32_t firedBitMask)
+		{
+			for (uint32_t i = 0; i < nofBindings; i++)
+			{
+				const Binding& binding = arBindings[i];
+				if ((binding.bitMask == firedBitMask) && ((binding.state == state) || (binding.state == anyState)))
+				{
+					(static_cast<DERIVED*>(this)->*binding.handler)();
+					return;
+				}
+			}
+		}
+
+	private:
+		void updateBitsToWaitFor()
+		{
+			bitsToWaitFor = 0;
+			for (uint32_t i = 0; i < nofBindings; i++)
+			{
+				if ((arBindings[i].state == state) || (arBindings[i].state == anyState))
+				{
+					bitsToWaitFor |= arBindings[i].bitMask;
+				}
+			}
+		}
+	};
+
+	template<unsigned int MAXSTATEMACHINES> class StateMachineTask : public Task, public IStateMachineTask
+	{
+	private:
+		IStateMachine* arStateMachines[MAXSTATEMACHINES] = {};
+		uint32_t nofStateMachines;
+
+	public:
+		StateMachineTask(const char *taskName, unsigned int taskPriority, unsigned int taskSizeBytes, unsigned int taskCoreNumber) :
+			Task(taskName, taskPriority, taskSizeBytes, taskCoreNumber), nofStateMachines(0)
+		{
+			start();
+		}
+
+		/*override keyword not supported in current compiler*/
+		void addStateMachine(IStateMachine* pStateMachine)
+		{
+			assert(nofStateMachines < MAXSTATEMACHINES);
+			arStateMachines[nofStateMachines++] = pStateMachine;
+		}
+
+		/*override keyword not supported in current compiler*/
+		Task* getTask()
+		{
+			return this;
+		}
+
+	private:
+		/*override keyword not supported in current compiler*/
+		void main()
+		{
+			while (true)
+			{
+				dumpStackHighWaterMarkIfIncreased();
+
+				uint32_t bitsToWaitFor = 0;
+				for (uint32_t i = 0; i < nofStateMachines; i++)
+				{
+					bitsToWaitFor |= arStateMachines[i]->getBitsToWaitFor();
+				}
+				if (bitsToWaitFor == 0)
+				{
+					vTaskDelay(portMAX_DELAY);	// None of the machines can ever react anymore.
+					continue;
+				}
+
+				// Round robin: a machine with a lot of events can't starve the others.
+				Waitable* pFired = waitAnyNext(bitsToWaitFor, DispatchOrder::do_RoundRobin);
+				uint32_t firedBitMask = pFired->getBitMask();
+				for (uint32_t i = 0; i < nofStateMachines; i++)
+				{
+					if ((arStateMachines[i]->getBitsToWaitFor() & firedBitMask) != 0)
+					{
+						arStateMachines[i]->dispatch(firedBitMask);
+						break;
+					}
+				}
+			}
+		}
+	}; // end class StateMachineTask
+}; // end namespace crt
@@ -0,0 +1,119 @@
+#pragma once
+#include "internals/crt_FreeRTOS.h"
+#include "crt_Task.h"
+
+// by Marius Versteegen, 2023
+
+// A StaticHandler is a Handler of which the listeners are known at compile time.
+// Like with the Handler, the handler task periodically calls the update() member functions
+// of its listeners. The listener objects are members of the StaticHandler itself (laid out
+// one after the other), and their update() functions are called directly instead of via
+// a virtual function call. That allows the compiler to inline them.
+//
+// That matters for handlers with a short period and many small listeners.
+// (see the Benchmarks example for the dispatch overhead compared to that of the Handler)
+//
+//   StaticHandler<Blinker, Blinker, PidController> ledsAndMotor("LedsAndMotor", 2 /*priority*/, ARDUINO_RUNNING_CORE, 1 /*periodMs*/,
+//                                                              Blinker(pinLed1), Blinker(pinLed2), PidController(motor));
+//   ledsAndMotor.get<2>().setTarget(100);   // Access to a listener (mind the thread safety).
+//
+// The listeners are copied into the StaticHandler. They don't need to derive from IHandlerListener:
+// any class with an update() member function will do.
+//
+// Use the normal Handler if listeners need to be added or removed at runtime, or if they
+// need to be event driven, or prioritised.
+
+// This StaticHandler class assumes that 1 tick equals 1ms (see crt_Handler.h).
+
+namespace crt
+{
+	template<typename... LISTENERS> class StaticHandlerListeners;
+
+	template<> class StaticHandlerListeners<>
+	{
+	public:
+		inline void updateAll() {}
+	};
+
+	// The listeners, laid out one after the other.
+	template<typename FIRST, typename... REST> class StaticHandlerListeners<FIRST, REST...>
+	{
+	public:
+		FIRST first;
+		StaticHandlerListeners<REST...> rest;
+
+		StaticHandlerListeners()
+		{}
+
+		StaticHandlerListeners(const FIRST& first, const REST&... rest) : first(first), rest(rest...)
+		{}
+
+		inline void updateAll()
+		{
+			first.update();		// The type of first is known: no virtual call needed.
+			rest.updateAll();
+		}
+	};
+
+	// StaticHandlerListenerAt<I, StaticHandlerListeners<..>>::type is the type of listener I.
+	template<unsigned int I, typename LIST> struct StaticHandlerListenerAt;
+
+	template<typename FIRST, typename... REST> struct StaticHandlerListenerAt<0, StaticHandlerListeners<FIRST, REST...>>
+	{
+		typedef FIRST type;
+		static type& get(StaticHandlerListeners<FIRST, REST...>& listeners) { return listeners.first; }
+	};
+
+	template<unsigned int I, typename FIRST, typename... REST> struct StaticHandlerListenerAt<I, StaticHandlerListeners<FIRST, REST...>>
+	{
+		typedef StaticHandlerListenerAt<I - 1, StaticHandlerListeners<REST...>> Next;
+		typedef typename Next::type type;
+		static type& get(StaticHandlerListeners<FIRST, REST...>& listeners) { return Next::get(listeners.rest); }
+	};
+
+	template<typename... LISTENERS> class StaticHandler : public Task
+	{
+	private:
+		StaticHandlerListeners<LISTENERS...> listeners;
+		uint16_t periodMs;
+		uint64_t periodUs;
+
+	public:
+		StaticHandler(const char *taskName, unsigned int taskPriority, unsigned int taskCoreNumber, uint16_t periodMs, const LISTENERS&... listeners) :
+			Task(taskName, taskPriority, 5500, taskCoreNumber), listeners(listeners...), periodMs(periodMs), periodUs(periodMs*1000)
+		{
+			start();
+		}
+
+		template<unsigned int I> typename StaticHandlerListenerAt<I, StaticHandlerListeners<LISTENERS...>>::type& get()
+		{
+			return StaticHandlerListenerAt<I, StaticHandlerListeners<LISTENERS...>>::get(listeners);
+		}
+
+	private:
+		/*override keyword not supported in current compiler*/
+		void main()
+		{
+			uint64_t beforeAll	= esp_timer_get_time();
+			uint32_t diffAll	= 0;
+
+			while (true)
+			{
+				listeners.updateAll();
+
+				diffAll = (uint32_t)(esp_timer_get_time() - beforeAll);
+				if (diffAll >= periodUs)
+				{
+					ESP_LOGI("StaticHandler Delay too long:", "%d us", diffAll);
+				}
+				else
+				{
+					vTaskDelay((periodUs - diffAll) / 1000);
+				}
+				beforeAll = esp_timer_get_time();	 // This is the clean cut where the old interval ends
+
+				dumpStackHighWaterMarkIfIncreased();
+			}
+		}
+	}; // end class StaticHandler
+}; // end namespace crt
@@ -16,6 +16,13 @@ namespace crt
 {
     // extern ILogger& logger;
 
+    // The order in which waitAnyNext hands out waitables that fired at the same time.
+    // do_RoundRobin : the waitable after the one handed out previously goes first. 
+    //                 Every fired waitable is thus handled within nofWaitables calls (no starvation).
+    // do_Priority   : the waitable that was constructed first goes first. 
+    //                 (So declare the most important waitable first).
+    enum class DispatchOrder { do_RoundRobin, do_Priority };
+
 	class Task
 	{
 	protected:
@@ -25,6 +32,10 @@ namespace crt
 		EventGroupHandle_t hEventGroup;
 		uint32_t latestResult = 0;
 
+        Waitable* arWaitables[24] = {};     // Indexed by bitnumber.
+        uint32_t pendingBits = 0;           // Fired (and already cleared) bits, not handed out by waitAnyNext yet.
+        uint32_t nextBitNumber = 0;         // Where the next round robin search starts.
+
 	public:
 		const char *taskName;
 		unsigned int taskPriority;
@@ -33,7 +44,8 @@ namespace crt
 		TaskHandle_t taskHandle;
 
 		uint32_t nofWaitables;
-        uint32_t queuesMask;        // Every bit in this mask belongs to a queue.
+        uint32_t queuesMask;        // Every bit in this mask belongs to a queue, or to another waitable that 
+                                    // stays fired till it has been read empty (like a topic subscriber or a semaphore).
         uint32_t flagsMask;         // Every bit in this mask belongs to a flag.
         uint32_t timersMask;        // Every bit in this mask belongs to a timer.
 
@@ -54,6 +66,8 @@ namespace crt
             switch (pWaitable->getType())
             {
             case WaitableType::wt_Queue:
+            case WaitableType::wt_Subscriber:
+            case WaitableType::wt_Semaphore:
                 queuesMask |= (1 << nofWaitables);
                 break;
             case WaitableType::wt_Timer:
@@ -65,6 +79,7 @@ namespace crt
             default:
                 break;
             }
+            arWaitables[nofWaitables] = pWaitable;
             return nofWaitables++;
         }
 
@@ -78,6 +93,20 @@ namespace crt
             xEventGroupSetBits(hEventGroup,uxBitsToSet);
         }
 
+        // To be called from an interrupt handler instead of setEventBits.
+        // Note: it defers the setting of the bits to the FreeRTOS timer task.
+        // Returns false if that failed, because the command queue of the timer task was full.
+        inline bool setEventBitsFromISR(const EventBits_t uxBitsToSet)
+        {
+            BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+            BaseType_t rc = xEventGroupSetBitsFromISR(hEventGroup, uxBitsToSet, &xHigherPriorityTaskWoken);
+            if (xHigherPriorityTaskWoken == pdTRUE)
+            {
+                portYIELD_FROM_ISR();
+            }
+            return (rc == pdPASS);
+        }
+
         inline void clearEventBits(const EventBits_t uxBitsToClear)
         {
             xEventGroupClearBits(hEventGroup, uxBitsToClear);
@@ -148,33 +177,181 @@ namespace crt
         // So there's no need to check with hasFired.
 		inline void waitAll(uint32_t bitsToWaitFor)
 		{
-			latestResult = xEventGroupWaitBits(
-				hEventGroup,
-				bitsToWaitFor,
-				pdTRUE, // xClearOnExit, We'd like to set it to false, but that would create a race condition, right after this function returns, another thread could set another flag. .  Waiting for all, all bits can be cleared!.. except for the queue bits - they can only become cleared after reading from the queue has emptied it..
-				pdTRUE, // xWaitForAllBits
-				portMAX_DELAY); // xTicksToWait)
-
-            // Actually, we didn't want to clear the queue bits, so let's repair that:
-            setEventBits(queuesMask & latestResult);
+            waitAllTicks(bitsToWaitFor, portMAX_DELAY);
 		}
 
-		// return value: the bits that were set at the time of firing.
+		// return value: the waited-for bits that were set at the time of firing.
         // Use hasFired() to determine which one.
         // It is possible that multiple event bits were set at the same time.
         // For a clean design, stop after finding the first one using hasFired.
         //
         // Thus, it is advised always to process only the actions on a single event after a waitAny.
-		inline void waitAny(uint32_t bitsToWaitFor)
+		inline uint32_t waitAny(uint32_t bitsToWaitFor)
 		{
+            return waitAnyTicks(bitsToWaitFor, portMAX_DELAY) & bitsToWaitFor;
+		}
+
+        // The functions below are the same as the ones above, except that they give up
+        // after a timeout (in ms), or at a deadline (a tick count, like xTaskGetTickCount() + 100).
+        // That way, no extra Timer (and event bit) is needed to implement a timeout.
+        //
+        // wait and waitAll return false if the timeout expired before (all) the waitables fired.
+        // waitAny returns 0 if the timeout expired before any of the waitables fired,
+        // otherwise it returns the waited-for bits that fired. (Use hasFired() as usual).
+
+        inline bool wait(Waitable& waitable, uint32_t timeoutMs)
+        {
+            return waitAll(waitable.getBitMask(), timeoutMs);
+        }
+
+        inline bool waitAll(uint32_t bitsToWaitFor, uint32_t timeoutMs)
+        {
+            return waitAllTicks(bitsToWaitFor, msToTicks(timeoutMs));
+        }
+
+        inline uint32_t waitAny(uint32_t bitsToWaitFor, uint32_t timeoutMs)
+        {
+            return waitAnyTicks(bitsToWaitFor, msToTicks(timeoutMs)) & bitsToWaitFor;
+        }
+
+        inline bool waitUntil(Waitable& waitable, TickType_t deadline)
+        {
+            return waitAllUntil(waitable.getBitMask(), deadline);
+        }
+
+        inline bool waitAllUntil(uint32_t bitsToWaitFor, TickType_t deadline)
+        {
+            return waitAllTicks(bitsToWaitFor, getTicksLeft(deadline));
+        }
+
+        inline uint32_t waitAnyUntil(uint32_t bitsToWaitFor, TickType_t deadline)
+        {
+            return waitAnyTicks(bitsToWaitFor, getTicksLeft(deadline)) & bitsToWaitFor;
+        }
+
+        // waitAnyNext is an alternative for waitAny followed by a chain of hasFired checks:
+        //
+        //     Waitable* pFired = waitAnyNext(flag1 + queue1 + timer1);
+        //     if (pFired == &flag1) { .. } 
+        //     else if (pFired == &queue1) { queue1.read(number); .. }
+        //
+        // It returns a single fired waitable, chosen by dispatchOrder. All the waitables that
+        // fired together are consumed with a single event group call, and handed out one by one
+        // by the subsequent calls, without waiting again.
+        // A queue remains "fired" as long as it is not empty, like with waitAny.
+        inline Waitable* waitAnyNext(uint32_t bitsToWaitFor, DispatchOrder dispatchOrder = DispatchOrder::do_RoundRobin)
+        {
+            return waitAnyNextTicks(bitsToWaitFor, portMAX_DELAY, dispatchOrder);
+        }
+
+        // Same as above, but returns nullptr if none of the waitables fired within timeoutMs.
+        inline Waitable* waitAnyNext(uint32_t bitsToWaitFor, uint32_t timeoutMs, DispatchOrder dispatchOrder = DispatchOrder::do_RoundRobin)
+        {
+            return waitAnyNextTicks(bitsToWaitFor, msToTicks(timeoutMs), dispatchOrder);
+        }
+
+        // Unlike pdMS_TO_TICKS, it rounds up (so that a timeout of 1ms with 10ms ticks does not
+        // become 0: no waiting at all), and it does not overflow for long timeouts.
+        // The result is clamped below portMAX_DELAY, which would mean: wait forever.
+        static inline TickType_t msToTicks(uint32_t timeoutMs)
+        {
+            uint64_t ticks = ((uint64_t)timeoutMs * configTICK_RATE_HZ + 999) / 1000;
+            return (ticks < (uint64_t)portMAX_DELAY) ? (TickType_t)ticks : (portMAX_DELAY - 1);
+        }
+
+    private:
+        static inline TickType_t getTicksLeft(TickType_t deadline)
+        {
+            // The subtraction wraps correctly when the tick count overflows.
+            int32_t ticksLeft = (int32_t)(deadline - xTaskGetTickCount());
+            return (ticksLeft > 0) ? (TickType_t)ticksLeft : 0;
+        }
+
+        inline Waitable* waitAnyNextTicks(uint32_t bitsToWaitFor, TickType_t ticksToWait, DispatchOrder dispatchOrder)
+        {
+            if ((pendingBits & bitsToWaitFor) == 0)
+            {
+                uint32_t firedBits = xEventGroupWaitBits(hEventGroup, bitsToWaitFor, pdFALSE, pdFALSE, ticksToWait) & bitsToWaitFor;
+                if (firedBits == 0)
+                {
+                    return nullptr; // Timed out.
+                }
+                // Consume everything that fired at once, except for the queue bits (those are consumed by reading).
+                clearEventBits(firedBits & ~queuesMask);
+                pendingBits |= firedBits;
+            }
+
+            uint32_t candidates = pendingBits & bitsToWaitFor;
+            uint32_t bitNumber = 0;
+            if (dispatchOrder == DispatchOrder::do_RoundRobin)
+            {
+                uint32_t candidatesFromNext = candidates & ~((1u << nextBitNumber) - 1);
+                bitNumber = __builtin_ctz(candidatesFromNext != 0 ? candidatesFromNext : candidates);
+                nextBitNumber = (bitNumber + 1) % 24;
+            }
+            else
+            {
+                bitNumber = __builtin_ctz(candidates);
+            }
+
+            pendingBits &= ~(1u << bitNumber);
+            return arWaitables[bitNumber];
+        }
+
+        // Waitables that were consumed by waitAnyNext, but not handed out yet, are set again
+        // before a normal wait. That way, no event gets lost when both ways of waiting are mixed.
+        inline void restorePendingBits()
+        {
+            if (pendingBits != 0)
+            {
+                setEventBits(pendingBits & ~queuesMask);
+                pendingBits = 0;
+            }
+        }
+
+        inline bool waitAllTicks(uint32_t bitsToWaitFor, TickType_t ticksToWait)
+        {
+            restorePendingBits();
+
+            // If only queues are waited for (like with wait(queue)), nothing needs to be cleared:
+            // the queue bits are only cleared by the queues themselves, when they become empty.
+            bool bOnlyQueues = ((bitsToWaitFor & ~queuesMask) == 0);
+
+			latestResult = xEventGroupWaitBits(
+				hEventGroup,
+				bitsToWaitFor,
+				bOnlyQueues ? pdFALSE : pdTRUE, // xClearOnExit, We'd like to set it to false, but that would create a race condition, right after this function returns, another thread could set another flag. .  Waiting for all, all bits can be cleared!.. except for the queue bits - they can only become cleared after reading from the queue has emptied it..
+				pdTRUE, // xWaitForAllBits
+				ticksToWait); // xTicksToWait)
+
+            if ((latestResult & bitsToWaitFor) != bitsToWaitFor)
+            {
+                // Timed out. (Nothing has been cleared in that case)
+                latestResult &= bitsToWaitFor;
+                return false;
+            }
+
+            if (!bOnlyQueues && ((queuesMask & latestResult) != 0))
+            {
+                // Actually, we didn't want to clear the queue bits, so let's repair that:
+                setEventBits(queuesMask & latestResult);
+            }
+            return true;
+        }
+
+        inline uint32_t waitAnyTicks(uint32_t bitsToWaitFor, TickType_t ticksToWait)
+        {
+            restorePendingBits();
 			latestResult = xEventGroupWaitBits(
 				hEventGroup,
 				bitsToWaitFor,
 				pdFALSE, // xClearOnExit,  Waiting for any: individual "hasFired" checks are needed. They will clear/consume the corresponding event.
 				pdFALSE, // xWaitForAllBits,
-				portMAX_DELAY); // xTicksToWait)
-		}
+				ticksToWait); // xTicksToWait)
+            return latestResult;
+        }
 
+    public:
 		inline bool hasFired(Waitable& waitable)
 		{
             uint32_t bitmask = waitable.getBitMask();
@@ -0,0 +1,116 @@
+// by Marius Versteegen, 2023
+
+// A TokenBucket is meant for pacing a producer task, such that it doesn't flood a consumer.
+// The bucket is refilled with tokensPerSecond tokens, up to burstSize tokens.
+// The producer takes a token for each item it produces. If the bucket is empty, take()
+// returns false, and the bucket fires as soon as the next token has been added.
+// (see the TokenBucket example in the examples folder)
+//
+//   TokenBucket tokenBucket;                        // Member of the producing task,
+//   tokenBucket(this, 100, 10)                      // initialised in its constructor (tokensPerSecond, burstSize).
+//
+//   while (!tokenBucket.take())                     // Within the main of the producing task.
+//   {
+//       wait(tokenBucket);                          // Or waitAny, together with other waitables.
+//   }
+//   consumer.write(item);
+//
+// The bucket is refilled lazily, based on the elapsed time. Its internal Timer is only
+// started when a take() finds it empty.
+// Like a Timer, a TokenBucket can only be used by the task that owns it.
+// It can be waited for like any other waitable (it forwards the Waitable of its Timer), but
+// its Timer itself can't be reached from outside.
+
+#pragma once
+#include "internals/crt_FreeRTOS.h"
+#include "crt_Timer.h"
+
+namespace crt
+{
+	class TokenBucket
+	{
+	private:
+		Timer timer;				// Fires when the next token has been added.
+		uint32_t tokenPeriodUs;		// The time it takes to add a single token.
+		uint32_t burstSize;
+		uint32_t nofTokens;
+		int64_t lastRefillUs;
+
+	public:
+		TokenBucket(Task* pTask, uint32_t tokensPerSecond, uint32_t burstSize) :
+			timer(pTask), tokenPeriodUs(toTokenPeriodUs(tokensPerSecond)), burstSize(burstSize), nofTokens(burstSize), lastRefillUs(esp_timer_get_time())
+		{
+			assert(tokenPeriodUs >= 50);	// assert against bad design (see the minimum duration of a Timer).
+			assert(burstSize > 0);
+		}
+
+		// To wait for the bucket, like for any other waitable: wait(tokenBucket), hasFired(tokenBucket),
+		// waitAny(tokenBucket + flag).
+		operator Waitable&()
+		{
+			return timer;
+		}
+
+		uint32_t getBitMask() const
+		{
+			return timer.getBitMask();
+		}
+
+		uint32_t operator+(uint32_t other)
+		{
+			return timer + other;
+		}
+
+		uint32_t operator+(Waitable& other)
+		{
+			return timer + other;
+		}
+
+		// Returns false if there was no token. In that case, the bucket fires when there is one.
+		bool take()
+		{
+			int64_t nowUs = esp_timer_get_time();
+			refill(nowUs);
+			if (nofTokens > 0)
+			{
+				nofTokens--;
+				return true;
+			}
+			uint64_t waitUs = (uint64_t)(lastRefillUs + tokenPeriodUs - nowUs);
+			timer.start((waitUs < 50) ? 50 : waitUs);
+			return false;
+		}
+
+		uint32_t getNofTokens()
+		{
+			refill(esp_timer_get_time());
+			return nofTokens;
+		}
+
+	private:
+		static uint32_t toTokenPeriodUs(uint32_t tokensPerSecond)
+		{
+			assert(tokensPerSecond > 0);
+			return (tokensPerSecond > 0) ? (1000000 / tokensPerSecond) : 1000000;
+		}
+
+		inline void refill(int64_t nowUs)
+		{
+			int64_t nofNewTokens = (nowUs - lastRefillUs) / tokenPeriodUs;
+			if (nofNewTokens == 0)
+			{
+				return;
+			}
+			if (nofNewTokens >= (int64_t)(burstSize - nofTokens))
+			{
+				nofTokens = burstSize;
+				lastRefillUs = nowUs;	// A full bucket doesn't save up time.
+			}
+			else
+			{
+				nofTokens += (uint32_t)nofNewTokens;
+				lastRefillUs += nofNewTokens * tokenPeriodUs;
+			}
+		}
+	};
+};
@@ -0,0 +1,150 @@
+// by Marius Versteegen, 2023
+
+// A Topic is meant for broadcasting data from one (or more) tasks to multiple other tasks.
+// Instead of writing the same item into a separate Queue for every receiving task,
+// the publisher publishes the item once, into a ring buffer that is shared by all subscribers.
+//
+// Every receiving task owns a Topic::Subscriber, which is a waitable. It has its own read
+// position in the ring buffer, and it fires as long as there are items it did not read yet.
+//
+// The publisher never waits for slow subscribers. If a subscriber falls more than DEPTH items
+// behind, the oldest items are skipped for that subscriber, and its overrun count is increased.
+// DEPTH should be a power of 2, such that the slots keep following each other when the
+// 32-bit item counts wrap around.
+// (see the Topic example in the examples folder)
+//
+//   Topic<int32_t, 8> topicNumbers;                         // Typically defined in main.cpp (or .ino)
+//
+//   Topic<int32_t, 8>::Subscriber subscriberNumbers;        // Member of a receiving task,
+//   subscriberNumbers(this, topicNumbers)                   // initialised in its constructor.
+//
+//   wait(subscriberNumbers);                                // Within the main of the receiving task.
+//   subscriberNumbers.read(number);
+//
+//   topicNumbers.publish(number);                           // From any task.
+
+#pragma once
+#include "internals/crt_FreeRTOS.h"
+#include "internals/crt_SimpleMutex.h"
+#include "crt_Waitable.h"
+#include "crt_Task.h"
+
+namespace crt
+{
+	template<typename TYPE, uint32_t DEPTH, uint32_t MAXSUBSCRIBERS = 8> class Topic
+	{
+	public:
+		class Subscriber : public Waitable
+		{
+			friend class Topic;
+
+		private:
+			Task* pTask;
+			Topic& topic;
+			uint32_t readCount;		// The publishCount of the next item to read.
+			uint32_t overrunCount;	// The amount of items that were skipped because this subscriber fell behind.
+
+		public:
+			Subscriber(Task* pTask, Topic& topic) : Waitable(WaitableType::wt_Subscriber), pTask(pTask), topic(topic), readCount(0), overrunCount(0)
+			{
+				Waitable::init(pTask->queryBitNumber(this));
+				topic.subscribe(this);
+			}
+
+			// Returns false if there was nothing to read.
+			bool read(TYPE& item)
+			{
+				return topic.read(this, item);
+			}
+
+			uint32_t getNofItemsWaiting()
+			{
+				return topic.getNofItemsWaiting(this);
+			}
+
+			uint32_t getOverrunCount()
+			{
+				return overrunCount;
+			}
+		};
+
+	private:
+		TYPE arItems[DEPTH];
+		uint32_t publishCount;		// Total amount of items published (wraps around).
+		Subscriber* arSubscribers[MAXSUBSCRIBERS] = {};
+		uint32_t nofSubscribers;
+		SimpleMutex simpleMutex;	// No deadlock risk: no other mutexes are locked while it is held.
+
+	public:
+		Topic() : publishCount(0), nofSubscribers(0)
+		{
+			static_assert((DEPTH != 0) && ((DEPTH & (DEPTH - 1)) == 0), "DEPTH should be a power of 2 (the slot index is the item count modulo DEPTH, which should not jump when the count wraps around)");
+		}
+
+		// Copies the item once. Every subscriber that had read everything before gets notified.
+		void publish(const TYPE& item)
+		{
+			simpleMutex.lock();
+			arItems[publishCount % DEPTH] = item;
+			for (uint32_t i = 0; i < nofSubscribers; i++)
+			{
+				Subscriber* pSubscriber = arSubscribers[i];
+				if (pSubscriber->readCount == publishCount)
+				{
+					// This subscriber becomes non-empty.
+					pSubscriber->pTask->setEventBits(pSubscriber->getBitMask());
+				}
+			}
+			publishCount++;
+			simpleMutex.unlock();
+		}
+
+	private:
+		void subscribe(Subscriber* pSubscriber)
+		{
+			simpleMutex.lock();
+			assert(nofSubscribers < MAXSUBSCRIBERS);
+			pSubscriber->readCount = publishCount;	// Only items published from now on are received.
+			arSubscribers[nofSubscribers++] = pSubscriber;
+			simpleMutex.unlock();
+		}
+
+		bool read(Subscriber* pSubscriber, TYPE& item)
+		{
+			simpleMutex.lock();
+			uint32_t nofItemsWaiting = publishCount - pSubscriber->readCount;
+			if (nofItemsWaiting == 0)
+			{
+				simpleMutex.unlock();
+				return false;
+			}
+
+			if (nofItemsWaiting > DEPTH)
+			{
+				// The oldest items have been overwritten already.
+				pSubscriber->overrunCount += (nofItemsWaiting - DEPTH);
+				pSubscriber->readCount = publishCount - DEPTH;
+			}
+
+			item = arItems[pSubscriber->readCount % DEPTH];
+			pSubscriber->readCount++;
+
+			if (pSubscriber->readCount == publishCount)
+			{
+				// This subscriber becomes empty. (As publishing happens while holding the
+				// same mutex, that cannot race with the setting of the bit).
+				pSubscriber->pTask->clearEventBits(pSubscriber->getBitMask());
+			}
+			simpleMutex.unlock();
+			return true;
+		}
+
+		uint32_t getNofItemsWaiting(Subscriber* pSubscriber)
+		{
+			simpleMutex.lock();
+			uint32_t nofItemsWaiting = publishCount - pSubscriber->readCount;
+			simpleMutex.unlock();
+			return (nofItemsWaiting > DEPTH) ? DEPTH : nofItemsWaiting;
+		}
+	};
+};
@@ -4,12 +4,12 @@
 #include "crt_CleanRTOS.h"
 
 // Waitable is the base class of anything that a task can wait for.
-// It is the base class of Flag, Queueand Timer.
+// It is the base class of Flag, Queue, Semaphore, Timer and Topic::Subscriber.
 // You don't need to use it directly yourself.
 
 namespace crt 
 {
-	enum class WaitableType { wt_None, wt_Queue, wt_Flag, wt_Timer };
+	enum class WaitableType { wt_None, wt_Queue, wt_Flag, wt_Timer, wt_Subscriber, wt_Semaphore };
 
 	class Waitable
 	{
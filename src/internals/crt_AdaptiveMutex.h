@@ -0,0 +1,92 @@
+// by Marius Versteegen, 2023
+
+#pragma once
+#include <atomic>
+#include "internals/crt_FreeRTOS.h"
+#include "crt_Config.h"
+
+namespace crt
+{
+	// An AdaptiveMutex is meant for short critical sections that are shared by tasks on both cores.
+	// Like the SimpleMutex, it does not detect deadlock situations by itself.
+	//
+	// If the mutex is locked by a task that is running on the other core, that task might release
+	// it any moment. Then, blocking (which costs two task switches) would take much longer than the 
+	// critical section itself. So in that case, the mutex first spins a bounded number of times 
+	// (ADAPTIVE_MUTEX_SPINCOUNT, see crt_Config.h) on an atomic, before falling back to a
+	// blocking wait. If the mutex is locked by a task on the same core, spinning is of no use:
+	// it blocks right away.
+	//
+	// Internally, a FreeRTOS mutex is used, so priority inheritance still applies while blocking.
+	// (see the Benchmarks example for the handoff latencies compared to those of a SimpleMutex)
+	
+	class AdaptiveMutex
+	{
+	private:
+		static const int32_t noCore = -1;
+
+		SemaphoreHandle_t freeRtosMutex;
+		::std::atomic<int32_t> holderCore;	// The core on which the holder locked it. Just a hint.
+		
+	public:
+		AdaptiveMutex() :
+			freeRtosMutex(xSemaphoreCreateMutex()), holderCore(noCore)
+		{
+			assert(freeRtosMutex != NULL);	// If failed, not enough heap memory.
+		}
+		
+		void lock()
+		{
+			bool bResult = lock(portMAX_DELAY);
+			assert(bResult);
+			(void)bResult;	// Only used by the assert.
+		}
+
+		// Returns false if the mutex was locked already. Never spins or blocks.
+		bool tryLock()
+		{
+			if (xSemaphoreTake(freeRtosMutex, 0) != pdPASS)
+			{
+				return false;
+			}
+			holderCore.store(xPortGetCoreID(), ::std::memory_order_relaxed);
+			return true;
+		}
+
+		// Returns false if the mutex could not be locked within ticksToWait.
+		bool lock(TickType_t ticksToWait)
+		{
+			if (xSemaphoreTake(freeRtosMutex, 0) != pdPASS)
+			{
+				int32_t thisCore = xPortGetCoreID();
+				bool bLocked = false;
+				for (uint32_t i = 0; (i < ADAPTIVE_MUTEX_SPINCOUNT) && !bLocked; i++)
+				{
+					int32_t core = holderCore.load(::std::memory_order_relaxed);
+					if (core == thisCore)
+					{
+						break;	// The holder can't release it while this task keeps its core busy.
+					}
+					if (core == noCore)
+					{
+						bLocked = (xSemaphoreTake(freeRtosMutex, 0) == pdPASS);
+					}
+				}
+
+				if (!bLocked && (xSemaphoreTake(freeRtosMutex, ticksToWait) != pdPASS))
+				{
+					return false;
+				}
+			}
+			holderCore.store(xPortGetCoreID(), ::std::memory_order_relaxed);
+			return true;
+		}
+		
+		void unlock()
+		{
+			holderCore.store(noCore, ::std::memory_order_relaxed);
+			BaseType_t rc = xSemaphoreGive(freeRtosMutex);
+			assert(rc == pdPASS);
+		}
+	};
+};
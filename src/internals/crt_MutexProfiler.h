@@ -0,0 +1,122 @@
+// by Marius Versteegen, 2023
+
+#pragma once
+#include <atomic>
+#include "internals/crt_FreeRTOS.h"
+#include "crt_Config.h"
+#include "crt_AdaptiveMutex.h"
+
+namespace crt
+{
+	// The contention statistics of a single Mutex. (see MutexProfiler in crt_Mutex.h)
+	struct MutexStats
+	{
+		uint32_t mutexID;
+		uint32_t nofAcquisitions;
+		uint32_t nofContendedAcquisitions;	// Acquisitions for which the mutex was locked by another task already.
+		uint64_t totalWaitUs;				// Total time spent waiting for the mutex by contended acquisitions.
+		uint32_t maxWaitUs;
+		uint32_t maxHoldUs;					// Longest time the mutex was held at once.
+	};
+
+	// A MutexStatsRecorder is owned by a Mutex, if CRT_MUTEX_PROFILING is defined.
+	// Its record-functions are called while the mutex is locked, so the mutex protects the 
+	// recorder as well. Only copyStats and reset need to lock the mutex themselves.
+	// (they lock it directly: that does not count as an acquisition)
+	class MutexStatsRecorder
+	{
+	private:
+		AdaptiveMutex& adaptiveMutex;	// The mutex of which the statistics are recorded.
+		MutexStats stats;
+		int64_t lockTimeUs;
+
+	public:
+		MutexStatsRecorder(uint32_t mutexID, AdaptiveMutex& adaptiveMutex) : adaptiveMutex(adaptiveMutex), lockTimeUs(0)
+		{
+			stats = MutexStats();
+			stats.mutexID = mutexID;
+			registerRecorder(this);
+		}
+
+		// To be called right after the mutex was locked.
+		void recordLocked(int64_t waitStartUs, bool bContended)
+		{
+			lockTimeUs = esp_timer_get_time();
+			stats.nofAcquisitions++;
+			if (bContended)
+			{
+				uint32_t waitUs = (uint32_t)(lockTimeUs - waitStartUs);
+				stats.nofContendedAcquisitions++;
+				stats.totalWaitUs += waitUs;
+				if (waitUs > stats.maxWaitUs)
+				{
+					stats.maxWaitUs = waitUs;
+				}
+			}
+		}
+
+		// To be called right before the mutex is unlocked.
+		void recordUnlocking()
+		{
+			uint32_t holdUs = (uint32_t)(esp_timer_get_time() - lockTimeUs);
+			if (holdUs > stats.maxHoldUs)
+			{
+				stats.maxHoldUs = holdUs;
+			}
+		}
+
+		// Can be called from any task.
+		void copyStats(MutexStats& statsCopy)
+		{
+			adaptiveMutex.lock();
+			statsCopy = stats;
+			adaptiveMutex.unlock();
+		}
+
+		// Can be called from any task.
+		void reset()
+		{
+			adaptiveMutex.lock();
+			uint32_t mutexID = stats.mutexID;
+			stats = MutexStats();
+			stats.mutexID = mutexID;
+			adaptiveMutex.unlock();
+		}
+
+		uint32_t getMutexID()
+		{
+			return stats.mutexID;
+		}
+
+		// All recorders, in order of construction. Mutexes are typically global objects,
+		// that live until the end of the program, so recorders are never unregistered.
+		static MutexStatsRecorder** getRecorders()
+		{
+			static MutexStatsRecorder* arRecorders[MAX_PROFILED_MUTEXES] = {};
+			return arRecorders;
+		}
+
+		static uint32_t getNofRecorders()
+		{
+			uint32_t nofRecorders = getNofRecordersAtomic().load();
+			return (nofRecorders < MAX_PROFILED_MUTEXES) ? nofRecorders : MAX_PROFILED_MUTEXES;
+		}
+
+	private:
+		static ::std::atomic<uint32_t>& getNofRecordersAtomic()
+		{
+			static ::std::atomic<uint32_t> nofRecorders(0);
+			return nofRecorders;
+		}
+
+		static void registerRecorder(MutexStatsRecorder* pRecorder)
+		{
+			uint32_t index = getNofRecordersAtomic().fetch_add(1);
+			assert(index < MAX_PROFILED_MUTEXES);	// Increase MAX_PROFILED_MUTEXES in crt_Config.h
+			if (index < MAX_PROFILED_MUTEXES)
+			{
+				getRecorders()[index] = pRecorder;
+			}
+		}
+	};
+};
@@ -0,0 +1,81 @@
+// by Marius Versteegen, 2023
+
+#pragma once
+#include <atomic>
+#include "internals/crt_FreeRTOS.h"
+
+namespace crt
+{
+	// A SimpleRwMutex protects a resource that is read by multiple threads concurrently,
+	// and written by one thread at a time. Like the SimpleMutex, it does not detect
+	// deadlock situations, so it should only be used in situations that cannot potentially
+	// yield deadlock situations, like inside an RwPool.
+	//
+	// It is writer-preferring: as soon as a writer waits, new readers wait till the writer
+	// is done. That way, a steady stream of readers cannot starve the writers.
+	//
+	// How it works:
+	// * A single atomic word holds the number of active readers, plus a "writer" bit.
+	//   As long as the writer bit is not set, a reader only increments the count: it doesn't 
+	//   touch any FreeRTOS object. Thus, readers on both cores really read in parallel.
+	// * Writers pass the gate (a FreeRTOS mutex) one at a time. A writer sets the writer bit,
+	//   and if readers are still active, it waits for the binary semaphore "noReaders", which the
+	//   last of them gives. It keeps holding the gate till it is done.
+	// * A reader that finds the writer bit set waits at the gate as well, till the writer is done.
+	
+	class SimpleRwMutex
+	{
+	private:
+		static const uint32_t writerBit = 0x80000000;
+		SemaphoreHandle_t gate;
+		SemaphoreHandle_t noReaders;
+		::std::atomic<uint32_t> state;	// The writer bit, and the number of active readers.
+		
+	public:
+		SimpleRwMutex() :
+			gate(xSemaphoreCreateMutex()), noReaders(xSemaphoreCreateBinary()), state(0)
+		{
+			assert((gate != NULL) && (noReaders != NULL));	// If failed, not enough heap memory.
+		}
+		
+		void lockRead()
+		{
+			uint32_t oldState = state.load();
+			while ((oldState & writerBit) == 0)
+			{
+				if (state.compare_exchange_weak(oldState, oldState + 1))
+				{
+					return;	// No writer: no need to pass the gate.
+				}
+			}
+
+			// A writer is busy or waiting. Wait till it is done.
+			xSemaphoreTake(gate, portMAX_DELAY);
+			state.fetch_add(1);	// While the gate is held, the writer bit is not set.
+			xSemaphoreGive(gate);
+		}
+		
+		void unlockRead()
+		{
+			if (state.fetch_sub(1) == (writerBit + 1))
+			{
+				xSemaphoreGive(noReaders);	// The last reader, and a writer is waiting for it.
+			}
+		}
+
+		void lockWrite()
+		{
+			xSemaphoreTake(gate, portMAX_DELAY);
+			if ((state.fetch_or(writerBit) & ~writerBit) != 0)
+			{
+				xSemaphoreTake(noReaders, portMAX_DELAY);	// Wait for the active readers to finish.
+			}
+		}
+
+		void unlockWrite()
+		{
+			state.fetch_and(~writerBit);
+			xSemaphoreGive(gate);
+		}
+	};
+};
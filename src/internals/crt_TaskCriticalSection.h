@@ -1,6 +1,7 @@
 // by Marius Versteegen, 2023
 
 #pragma once
+#include "crt_FreeRTOS.h"
 
 namespace crt
 {
@@ -13,12 +14,41 @@ namespace crt
 	//
 	// As this blocks all interrupts on both cores, try to make it last as short as possible.
 	// I believe typically, a critical section takes about a 1us to enter and exit.
+	//
+	// By default, all TaskCriticalSections share the single spinlock criticalSectionMutex.
+	// Then, unrelated critical sections on different cores wait for each other.
+	// Pass a SpinLock of the resource itself to avoid that (see below).
+	// (see the Benchmarks example for the enter/exit costs of the variants)
 	extern portMUX_TYPE criticalSectionMutex; // Implement this singleton in main.cpp
 
+	// A SpinLock protects a single resource that is shared by tasks on both cores.
+	class SpinLock
+	{
+	public:
+		portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+	};
+
 	class TaskCriticalSection
 	{
+	private:
+		portMUX_TYPE* pMux;
+	public:
+		TaskCriticalSection() : pMux(&criticalSectionMutex) { taskENTER_CRITICAL(pMux); };
+		explicit TaskCriticalSection(SpinLock& spinLock) : pMux(&spinLock.mux) { taskENTER_CRITICAL(pMux); };
+		~TaskCriticalSection() { taskEXIT_CRITICAL(pMux); };
+	};
+
+	// A CoreLocalSection only masks the interrupts of the core it runs on. It takes no spinlock,
+	// so it costs less and does not delay the other core at all.
+	// It protects data that is only accessed from a single core: by tasks that are pinned
+	// to that core, and by interrupt handlers that run on that core.
+	// Like TaskCriticalSection, it can be used recursively.
+	class CoreLocalSection
+	{
+	private:
+		UBaseType_t prevInterruptLevel;
 	public:
-		TaskCriticalSection() { taskENTER_CRITICAL(&criticalSectionMutex); };
-		~TaskCriticalSection() { taskEXIT_CRITICAL(&criticalSectionMutex); };
+		CoreLocalSection() : prevInterruptLevel(portSET_INTERRUPT_MASK_FROM_ISR()) {};
+		~CoreLocalSection() { portCLEAR_INTERRUPT_MASK_FROM_ISR(prevInterruptLevel); };
 	};
 };
@@ -0,0 +1,115 @@
+// by Marius Versteegen, 2023
+
+#pragma once
+#include <stdint.h>
+
+namespace crt
+{
+	namespace std
+	{
+		constexpr uint32_t log2Ceil(uint32_t n, uint32_t bits = 0)
+		{
+			return ((1u << bits) >= n) ? bits : log2Ceil(n, bits + 1);
+		}
+
+		// A fixed size set of pointers, with O(1) insert, erase and contains.
+		// (an open addressing hash table with linear probing)
+		// It is not thread safe by itself.
+		template<typename TYPE, uint32_t CAPACITY> class PointerSet
+		{
+		private:
+			// At least twice the capacity, to keep the probe sequences short.
+			static const uint32_t tableBits = (log2Ceil(2 * CAPACITY) < 1) ? 1 : log2Ceil(2 * CAPACITY);
+			static const uint32_t tableSize = (1u << tableBits);
+
+			TYPE* arSlots[tableSize] = {};
+			uint32_t nofItems;
+
+			static uint32_t indexOf(TYPE* pItem)
+			{
+				// Fibonacci hashing. The lower bits of pointers are mostly zero due to alignment.
+				uint32_t key = (uint32_t)((uintptr_t)pItem >> 2);
+				return (uint32_t)((key * 2654435769u) >> (32 - tableBits));
+			}
+
+			static uint32_t next(uint32_t index)
+			{
+				return (index + 1) & (tableSize - 1);
+			}
+
+		public:
+			PointerSet() : nofItems(0)
+			{}
+
+			// Returns false if the item was present already, or if the set is full.
+			bool insert(TYPE* pItem)
+			{
+				uint32_t index = indexOf(pItem);
+				while (arSlots[index] != nullptr)
+				{
+					if (arSlots[index] == pItem)
+					{
+						return false;
+					}
+					index = next(index);
+				}
+				if (nofItems == CAPACITY)
+				{
+					return false;
+				}
+				arSlots[index] = pItem;
+				nofItems++;
+				return true;
+			}
+
+			bool contains(TYPE* pItem)
+			{
+				for (uint32_t index = indexOf(pItem); arSlots[index] != nullptr; index = next(index))
+				{
+					if (arSlots[index] == pItem)
+					{
+						return true;
+					}
+				}
+				return false;
+			}
+
+			// Returns false if the item was not present.
+			bool erase(TYPE* pItem)
+			{
+				uint32_t index = indexOf(pItem);
+				while (arSlots[index] != pItem)
+				{
+					if (arSlots[index] == nullptr)
+					{
+						return false;
+					}
+					index = next(index);
+				}
+
+				// Shift the items behind it back, so that no probe sequence gets broken.
+				uint32_t hole = index;
+				for (index = next(index); arSlots[index] != nullptr; index = next(index))
+				{
+					uint32_t home = indexOf(arSlots[index]);
+					// Move the item into the hole, unless its home lies cyclically in (hole, index].
+					bool bHomeAfterHole = (hole <= index) ? ((home > hole) && (home <= index))
+					                                      : ((home > hole) || (home <= index));
+					if (!bHomeAfterHole)
+					{
+						arSlots[hole] = arSlots[index];
+						hole = index;
+					}
+				}
+				arSlots[hole] = nullptr;
+				nofItems--;
+				return true;
+			}
+
+			uint32_t size()
+			{
+				return nofItems;
+			}
+		};
+	};
+};